@@ -1,6 +1,12 @@
 // Copyright(c) 2024 Endless98. All Rights Reserved.
 
 #include "ChunkActor.h"
+
+static FRealtimeMeshSectionGroupKey GetSlabSectionGroupKey(const int32 SlabIndex)
+{
+	return FRealtimeMeshSectionGroupKey::Create(FRealtimeMeshLODKey{ 0 }, FName("ChunkSlab", SlabIndex));
+}
+
 AChunkActor::AChunkActor()
 {
 	if (!GetWorld() || GetWorld()->bIsTearingDown)
@@ -66,10 +72,13 @@ void AChunkActor::GenerateChunkCollision()
 	bShouldGenerateCollisionOverride = true;
 
 	bIsCollisionGenerated = true;
-	for (int32 SectionIndex{}; SectionIndex < MeshSectionKeys.Num(); SectionIndex++)
+	for (const FChunkSlabSections& Slab : SlabSections)
 	{
-		FRealtimeMeshSectionConfig SectionConfig(SectionIndex);
-		RealtimeMesh->UpdateSectionConfig(MeshSectionKeys[SectionIndex], SectionConfig, bShouldGenerateCollisionOverride);
+		for (int32 SectionIndex{}; SectionIndex < Slab.SectionKeys.Num(); SectionIndex++)
+		{
+			FRealtimeMeshSectionConfig SectionConfig(Slab.VoxelSections[SectionIndex]);
+			RealtimeMesh->UpdateSectionConfig(Slab.SectionKeys[SectionIndex], SectionConfig, bShouldGenerateCollisionOverride);
+		}
 	}
 }
 
@@ -86,45 +95,146 @@ void AChunkActor::GenerateChunkMesh(FChunkMeshData& ChunkMeshData, TArray<UMater
 		return;
 	}
 
-	if (ChunkMeshData.bIsMeshEmpty || ChunkMeshData.ChunkStreamSet.IsEmpty() || ChunkMeshData.VoxelSections.IsEmpty())
+	const int32 SlabIndex{ ChunkMeshData.SlabIndex };
+	if (SlabIndex < 0 || SlabIndex >= GetChunkSlabCount(VoxelCount))
+	{
+		UE_LOG(LogTemp, Error, TEXT("SlabIndex %i was OOB for a chunk with %i voxels per side!"), SlabIndex, VoxelCount);
+		return;
+	}
+	if (!SlabSections.IsValidIndex(SlabIndex))
+		SlabSections.SetNum(SlabIndex + 1);
+
+	const bool bIsSlabEmpty{ ChunkMeshData.bIsMeshEmpty || ChunkMeshData.ChunkStreamSet.IsEmpty() || ChunkMeshData.VoxelSections.IsEmpty() };
+	if (!bIsSlabEmpty && SlabSections[SlabIndex].bHasSectionGroup && SlabSections[SlabIndex].VoxelSections == ChunkMeshData.VoxelSections)
+	{
+		// The slab still has the same voxel values, so its sections and materials can stay and only the buffers are replaced
+		RealtimeMesh->UpdateSectionGroup(GetSlabSectionGroupKey(SlabIndex), ChunkMeshData.ChunkStreamSet);
+		SetActorEnableCollision(true);
+		bHasFinishedGeneration = true;
+
+		if (ChunkMeshData.bShouldGenCollision && !bShouldGenerateCollisionOverride)
+		{
+			bIsCollisionGenerated = false;
+			GenerateChunkCollision();
+		}
+		return;
+	}
+
+	// Recreating the group drops sections for voxel values that are no longer in this slab
+	RemoveSlabSectionGroup(SlabIndex);
+
+	if (bIsSlabEmpty)
 	{
-		SetActorEnableCollision(false);
+		SetActorEnableCollision(HasAnyMeshSections());
 		bHasFinishedGeneration = true;
-		for (FRealtimeMeshSectionKey &SectionKey : MeshSectionKeys)
-			RealtimeMesh->RemoveSection(SectionKey);
-		MeshSectionKeys.Empty();
 		return;
 	}
 	SetActorEnableCollision(true);
 
-	MeshSectionKeys.Empty();
 	RealtimeMesh->SetCollisionConfig(CollsionConfig);
 
+	FChunkSlabSections& Slab{ SlabSections[SlabIndex] };
+	const FRealtimeMeshSectionGroupKey GroupKey{ GetSlabSectionGroupKey(SlabIndex) };
 	for (int32 VoxelSectionIndex{}; VoxelSectionIndex < ChunkMeshData.VoxelSections.Num(); VoxelSectionIndex++)
 	{
+		const uint8 VoxelValue{ ChunkMeshData.VoxelSections[VoxelSectionIndex] };
 		if (!VoxelMaterials.IsValidIndex(VoxelSectionIndex) || VoxelMaterials[VoxelSectionIndex] == nullptr)
 		{
 			UE_LOG(LogTemp, Error, TEXT("VoxelMaterial[%i] was nullptr!"), VoxelSectionIndex);
-			bHasFinishedGeneration = true;
-
-			continue;
 		}
+		else // Material slots are shared by every slab, so they are indexed by voxel value rather than by section
+			RealtimeMesh->SetupMaterialSlot(VoxelValue, VoxelMaterials[VoxelSectionIndex]->GetFName(), VoxelMaterials[VoxelSectionIndex]);
 
-		RealtimeMesh->SetupMaterialSlot(VoxelSectionIndex, VoxelMaterials[VoxelSectionIndex]->GetFName(), VoxelMaterials[VoxelSectionIndex]);
+		Slab.SectionKeys.Add(FRealtimeMeshSectionKey::CreateForPolyGroup(GroupKey, VoxelSectionIndex));
+		Slab.VoxelSections.Add(VoxelValue);
 	}
 
-	const FRealtimeMeshLODKey LOD{0};
-	const FRealtimeMeshSectionGroupKey GroupKey{ FRealtimeMeshSectionGroupKey::Create(LOD, FName("ChunkGroundMesh")) };
-	for (int32 GroupIndex{}; GroupIndex < ChunkMeshData.VoxelSections.Num(); GroupIndex++)
-		MeshSectionKeys.Add(FRealtimeMeshSectionKey::CreateForPolyGroup(GroupKey, GroupIndex));
-
 	RealtimeMesh->CreateSectionGroup(GroupKey, ChunkMeshData.ChunkStreamSet);
+	Slab.bHasSectionGroup = true;
 
-	bShouldGenerateCollisionOverride = ChunkMeshData.bShouldGenCollision && LOD.Index() == 0;
-	bIsCollisionGenerated = bShouldGenerateCollisionOverride;
+	bHasFinishedGeneration = true;
 
-	for (int32 SectionIndex{}; SectionIndex < MeshSectionKeys.Num(); SectionIndex++)
-		RealtimeMesh->UpdateSectionConfig(MeshSectionKeys[SectionIndex], FRealtimeMeshSectionConfig(SectionIndex), bShouldGenerateCollisionOverride);
+	// Collision is all or nothing for the chunk, so if this slab is the first to want it, the slabs we didn't rebuild need it too
+	if (ChunkMeshData.bShouldGenCollision && !bShouldGenerateCollisionOverride)
+	{
+		bIsCollisionGenerated = false;
+		GenerateChunkCollision();
+		return;
+	}
 
-	bHasFinishedGeneration = true;
-}
\ No newline at end of file
+	for (int32 SectionIndex{}; SectionIndex < Slab.SectionKeys.Num(); SectionIndex++)
+		RealtimeMesh->UpdateSectionConfig(Slab.SectionKeys[SectionIndex], FRealtimeMeshSectionConfig(Slab.VoxelSections[SectionIndex]), bShouldGenerateCollisionOverride);
+}
+
+void AChunkActor::RemoveSlabSectionGroup(const int32 SlabIndex)
+{
+	if (!SlabSections.IsValidIndex(SlabIndex))
+		return;
+
+	FChunkSlabSections& Slab{ SlabSections[SlabIndex] };
+	if (Slab.bHasSectionGroup && RealtimeMesh && IsValid(RealtimeMesh))
+		RealtimeMesh->RemoveSectionGroup(GetSlabSectionGroupKey(SlabIndex));
+
+	Slab.SectionKeys.Empty();
+	Slab.VoxelSections.Empty();
+	Slab.bHasSectionGroup = false;
+}
+
+bool AChunkActor::HasAnyMeshSections() const
+{
+	for (const FChunkSlabSections& Slab : SlabSections)
+		if (!Slab.SectionKeys.IsEmpty())
+			return true;
+
+	return false;
+}
+
+void AChunkActor::ResetForPool()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(AChunkActor::ResetForPool);
+
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+
+	for (int32 SlabIndex{}; SlabIndex < SlabSections.Num(); SlabIndex++)
+	{
+		RemoveSlabSectionGroup(SlabIndex);
+		SlabSections[SlabIndex].MeshRevision++; // Drops any remesh still in flight for the old cell
+	}
+
+	Tags.Empty();
+	Voxels.Empty();
+	ChunkCell = FIntVector::ZeroValue;
+
+	bShouldGenerateCollisionOverride = false;
+	bHasFinishedGeneration = false;
+	bIsCollisionGenerated = false;
+	bIsSafeToDestroy = true;
+	bIsClientAttemptingToDestroyChunk = false;
+	bShouldDestroyWhenUnneeded = false;
+}
+
+void AChunkActor::ActivateFromPool(const FVector& NewLocation)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(AChunkActor::ActivateFromPool);
+
+	SetActorLocation(NewLocation, false, nullptr, ETeleportType::ResetPhysics);
+	SetActorHiddenInGame(false);
+
+	if (GetNetMode() == NM_DedicatedServer || GetNetMode() == NM_ListenServer) // Matches BeginPlay
+		bIsSafeToDestroy = false;
+}
+
+// Returns the new revision. A remesh started with it is only applied if no newer remesh of the slab was started since
+uint32 AChunkActor::StartSlabRemesh(const int32 SlabIndex)
+{
+	if (!SlabSections.IsValidIndex(SlabIndex))
+		SlabSections.SetNum(SlabIndex + 1);
+
+	return ++SlabSections[SlabIndex].MeshRevision;
+}
+
+bool AChunkActor::IsSlabRemeshCurrent(const int32 SlabIndex, const uint32 MeshRevision) const
+{
+	return SlabSections.IsValidIndex(SlabIndex) && SlabSections[SlabIndex].MeshRevision == MeshRevision;
+}
@@ -0,0 +1,129 @@
+// Copyright(c) 2024 Endless98. All Rights Reserved.
+
+#include "ChunkJobQueue.h"
+
+void FChunkJobQueue::ReplaceJobs(TArray<FChunkJob>& NewJobs)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkJobQueue::ReplaceJobs);
+
+	FScopeLock Lock(&QueueMutex);
+	Jobs = MoveTemp(NewJobs);
+	Jobs.Heapify();
+	DeferredJobs.Empty();
+
+	if (!Jobs.IsEmpty())
+		TriggerWorkerEvents();
+}
+
+void FChunkJobQueue::Push(const FChunkJob& Job)
+{
+	FScopeLock Lock(&QueueMutex);
+	Jobs.HeapPush(Job);
+	TriggerWorkerEvents();
+}
+
+bool FChunkJobQueue::Dequeue(FChunkJob& OutJob)
+{
+	FScopeLock Lock(&QueueMutex);
+	if (Jobs.IsEmpty())
+		return false;
+
+	Jobs.HeapPop(OutJob, EAllowShrinking::No);
+	return true;
+}
+
+void FChunkJobQueue::Defer(const FChunkJob& Job, uint32 ReleaseCountBeforeCheck)
+{
+	FScopeLock Lock(&QueueMutex);
+	if (ReleaseCount != ReleaseCountBeforeCheck) // Whatever the job was waiting on may have become ready while we checked, so it can go straight back in the queue
+	{
+		Jobs.HeapPush(Job);
+		TriggerWorkerEvents();
+		return;
+	}
+
+	DeferredJobs.Add(Job);
+}
+
+void FChunkJobQueue::ReleaseDeferredJobs()
+{
+	FScopeLock Lock(&QueueMutex);
+	ReleaseCount++;
+	if (DeferredJobs.IsEmpty())
+		return;
+
+	for (const FChunkJob& DeferredJob : DeferredJobs)
+		Jobs.HeapPush(DeferredJob);
+	DeferredJobs.Empty();
+
+	TriggerWorkerEvents();
+}
+
+uint32 FChunkJobQueue::GetReleaseCount() const
+{
+	FScopeLock Lock(&QueueMutex);
+	return ReleaseCount;
+}
+
+int32 FChunkJobQueue::Num() const
+{
+	FScopeLock Lock(&QueueMutex);
+	return Jobs.Num();
+}
+
+void FChunkJobQueue::AddWorkerEvent(FEvent* WorkerEvent)
+{
+	FScopeLock Lock(&QueueMutex);
+	WorkerEvents.AddUnique(WorkerEvent);
+}
+
+void FChunkJobQueue::RemoveWorkerEvent(FEvent* WorkerEvent)
+{
+	FScopeLock Lock(&QueueMutex);
+	WorkerEvents.Remove(WorkerEvent);
+}
+
+void FChunkJobQueue::WakeWorkers()
+{
+	FScopeLock Lock(&QueueMutex);
+	TriggerWorkerEvents();
+}
+
+FChunkJobTokenPtr FChunkJobQueue::StartJob(const FIntPoint& HeightmapCell)
+{
+	FChunkJobTokenPtr JobToken{ MakeShared<FChunkJobToken, ESPMode::ThreadSafe>(HeightmapCell) };
+
+	FScopeLock Lock(&QueueMutex);
+	InFlightJobs.Add(JobToken);
+	return JobToken;
+}
+
+void FChunkJobQueue::CancelJobs(TFunctionRef<bool(const FIntPoint& HeightmapCell)> ShouldCancel)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkJobQueue::CancelJobs);
+
+	FScopeLock Lock(&QueueMutex);
+	for (int32 JobIndex = InFlightJobs.Num() - 1; JobIndex >= 0; --JobIndex)
+	{
+		FChunkJobTokenPtr JobToken{ InFlightJobs[JobIndex].Pin() };
+		if (!JobToken.IsValid()) // Every chunk from this job was spawned or dropped
+		{
+			InFlightJobs.RemoveAtSwap(JobIndex, EAllowShrinking::No);
+			continue;
+		}
+
+		if (ShouldCancel(JobToken->HeightmapCell))
+		{
+			JobToken->bIsCancelled = true;
+			InFlightJobs.RemoveAtSwap(JobIndex, EAllowShrinking::No);
+		}
+	}
+}
+
+void FChunkJobQueue::TriggerWorkerEvents()
+{
+	// Worker events auto reset, so a trigger is never lost even if the ChunkThread isn't waiting yet
+	for (FEvent* WorkerEvent : WorkerEvents)
+		if (WorkerEvent)
+			WorkerEvent->Trigger();
+}
@@ -49,9 +49,15 @@ void AChunkManager::Tick(float DeltaTime)
 	TRACE_CPUPROFILER_EVENT_SCOPE(AChunkManager::Tick);
 
 	Super::Tick(DeltaTime);
-	if(UpdateTrackedLocations())
+	const bool bDidTrackedLocationsChange{ UpdateTrackedLocations() };
+	if(bDidTrackedLocationsChange)
 		UpateNearbyChunkCollisions();
 
+	SpawnQueuedChunks(bDidTrackedLocationsChange);
+
+	if (!DirtySlabsByChunkCell.IsEmpty())
+		RemeshDirtyChunks();
+
 	if (GetNetMode() == ENetMode::NM_DedicatedServer || GetNetMode() == ENetMode::NM_ListenServer)
 		HandleClientNeededServerData(); // Could happen asyncronously on a background thread if we can't get the lock immediately
 
@@ -73,6 +79,14 @@ void AChunkManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
 			ChunkThread->Stop();
 	ChunkThreads.Empty();
 
+	{
+		FScopeLock Lock(&ChunkSpawnQueueMutex);
+		ChunkSpawnQueue.Empty();
+	}
+	PendingChunkSpawns.Empty();
+	PooledChunks.Empty();
+	DirtySlabsByChunkCell.Empty();
+
 	Super::EndPlay(EndPlayReason);
 }
 
@@ -249,6 +263,7 @@ void AChunkManager::InitializeThreads()
 
 	GetWorld()->GetTimerManager().ClearTimer(RetryTimerHandle);
 	int32 NumThreadsToSpawn{ TotalThreadsAvailable - NumThreadsToKeepFree };
+	FChunkThread::ResetHeightmapCache(MaxCachedHeightmaps); // Cached heightmaps from a previous world won't match this one's seed or settings
 	UKismetSystemLibrary::PrintString(World, FString::Printf(TEXT("Creating %i threads for chunk generation"), NumThreadsToSpawn), true, false, FLinearColor::Green, 2.0f);
 	for (uint8 ThreadIndex{}; ThreadIndex < NumThreadsToSpawn; ThreadIndex++)
 	{
@@ -260,8 +275,7 @@ void AChunkManager::InitializeThreads()
 			FMath::Max(ChunkGenerationRadius, CollisionGenerationRadius),
 			ChunkDeletionBuffer,
 			AdjacentChunkVoxelBuffer,
-			ThreadWorkingSleepTime,
-			ThreadIdleSleepTime,
+			FMath::Clamp(ThreadCPUBudget, 0.05f, 1.0f),
 			TotalChunkVoxels,
 			ChunkSize,
 			VoxelCount,
@@ -272,6 +286,7 @@ void AChunkManager::InitializeThreads()
 			TerrainNoiseScale,
 			BiomeNoiseScale,
 			Seed,
+			bUseGreedyMeshing,
 			SaveGameName,
 			ThreadIndex);
 
@@ -282,8 +297,14 @@ void AChunkManager::InitializeThreads()
 bool AChunkManager::UpdateTrackedLocations()
 {
 	bool bWereLocationsChanged{};
+	bool bWereViewDirectionsChanged{};
+	bool bWerePredictedLocationsChanged{};
 	TArray< FIntPoint> ChangedLocations{};
 
+	PlayerViewDirections.SetNumZeroed(TrackedPlayers.Num());
+	PlayerVelocities.SetNumZeroed(TrackedPlayers.Num());
+	PredictedPlayerCells.SetNumZeroed(TrackedPlayers.Num());
+
 	for (int32 TrackedIndex{}; TrackedIndex < TrackedPlayers.Num(); TrackedIndex++)
 	{
 		APlayerController* TrackedPlayerController{ TrackedPlayers[TrackedIndex] };
@@ -300,26 +321,44 @@ bool AChunkManager::UpdateTrackedLocations()
 		}
 
 		bool bDidThisActorMove{ false };
-		FVector2D PlayerLocation{ GetChunkGridLocation(TrackedPlayerPawn->GetActorLocation(), ChunkSize) };
-		FIntPoint TrackedLocation{ FMath::RoundToInt32(PlayerLocation.X), FMath::RoundToInt32(PlayerLocation.Y) };
-		if (!PlayerLocations.IsValidIndex(TrackedIndex))
+		FIntPoint PlayerCell{ Get2DCellFromLocation(TrackedPlayerPawn->GetActorLocation(), ChunkSize) };
+		if (!PlayerCells.IsValidIndex(TrackedIndex))
 		{
-			PlayerLocations.Add(TrackedLocation);
-			ChangedLocations.Add(TrackedLocation);
+			PlayerCells.Add(PlayerCell);
+			ChangedLocations.Add(PlayerCell);
 			bDidThisActorMove = true;
 			bWereLocationsChanged = true;
 		}
-		else if (PlayerLocations[TrackedIndex] != TrackedLocation)
+		else if (PlayerCells[TrackedIndex] != PlayerCell)
 		{
-			PlayerLocations[TrackedIndex] = TrackedLocation;
-			ChangedLocations.Add(TrackedLocation);
+			PlayerCells[TrackedIndex] = PlayerCell;
+			ChangedLocations.Add(PlayerCell);
 			bDidThisActorMove = true;
 			bWereLocationsChanged = true;
 		}
 
+		// Used to prioritize the heightmaps the player can see or is heading towards
+		PlayerVelocities[TrackedIndex] = FVector2D(TrackedPlayerPawn->GetVelocity());
+		const FVector2D PredictedOffset{ (PlayerVelocities[TrackedIndex] * FMath::Max(PredictionSeconds, 0.f)).GetClampedToMaxSize(ChunkGenerationRadius * ChunkSize) };
+		const FIntPoint PredictedCell{ Get2DCellFromLocation(TrackedPlayerPawn->GetActorLocation() + FVector(PredictedOffset, 0.f), ChunkSize) };
+		if (PredictedPlayerCells[TrackedIndex] != PredictedCell) // Only changes when the prediction crosses into another chunk, so jobs aren't requeued every tick
+		{
+			PredictedPlayerCells[TrackedIndex] = PredictedCell;
+			bWerePredictedLocationsChanged = true;
+		}
+		if (TrackedPlayerController->IsLocalController())
+		{
+			const FVector2D ViewDirection{ FVector2D(TrackedPlayerController->GetControlRotation().Vector()).GetSafeNormal() };
+			if (!ViewDirection.IsNearlyZero() && FVector2D::DotProduct(ViewDirection, PlayerViewDirections[TrackedIndex]) < ViewDirectionRequeueDot) // Looking straight down keeps the last direction
+			{
+				PlayerViewDirections[TrackedIndex] = ViewDirection;
+				bWereViewDirectionsChanged = true;
+			}
+		}
+
 		if (!TrackedHasFoundChunkInSpawnLocation[TrackedIndex])
 		{
-			if (IsChunkGeneratedInThis2DLocation(PlayerLocation))
+			if (IsChunkGeneratedInThis2DCell(PlayerCell))
 			{
 				TrackedHasFoundChunkInSpawnLocation[TrackedIndex] = true;
 				// Unfreeze player once we see we have generate the chunk we're in
@@ -337,16 +376,21 @@ bool AChunkManager::UpdateTrackedLocations()
 			continue;
 
 		if (bDidThisActorMove)
-			ReplicateChunkNamesAsync(PlayerLocation);
+			ReplicateChunkNamesAsync(PlayerCell);
 	} // Remove all nullptr TrackedPlayers:
 
-	if (bWasGenRangeChanged || bWereLocationsChanged)
+	if (bWasGenRangeChanged || bWereLocationsChanged || bWereViewDirectionsChanged || bWerePredictedLocationsChanged)
+		bHasUnpublishedTrackedLocations = true;
+
+	if (bHasUnpublishedTrackedLocations && ThreadPlayerLocationsLock.TryWriteLock()) // If a ChunkThread is reading them, we try again next tick
 	{
-		if (ThreadPlayerLocationsLock.TryWriteLock())
-		{
-			ThreadUseableLocations = PlayerLocations;
-			ThreadPlayerLocationsLock.WriteUnlock();
-		}
+		ThreadUseablePlayerCells = PlayerCells;
+		ThreadUseablePredictedCells = PredictedPlayerCells;
+		ThreadUseableViewDirections = PlayerViewDirections;
+		ThreadUseableVelocities = PlayerVelocities; // Only published with the other changes, so it's the velocity when the jobs were last queued
+		ThreadPlayerLocationsLock.WriteUnlock();
+		bHasUnpublishedTrackedLocations = false;
+		ChunkJobQueue.WakeWorkers(); // The first ChunkThread will queue up the newly needed heightmaps
 	}
 
 	for (int32 PlayerIndex{}; PlayerIndex < TrackedPlayers.Num(); PlayerIndex++)
@@ -357,7 +401,7 @@ bool AChunkManager::UpdateTrackedLocations()
 		}
 
 	if (bWereLocationsChanged && (GetNetMode() == ENetMode::NM_DedicatedServer || GetNetMode() == ENetMode::NM_ListenServer))
-		ReplicatePlayerChunkLocations(PlayerLocations);
+		ReplicatePlayerChunkLocations(PlayerCells);
 
 	return bWereLocationsChanged;
 }
@@ -372,12 +416,12 @@ void AChunkManager::UpateNearbyChunkCollisions()
 	TArray<FIntVector> FoundChunkCells{};
 	TArray<AChunkActor*> FoundChunks{};
 	TArray<FIntPoint> Missing2DCells{};
-	for (FVector2D PlayerLocation : PlayerLocations)
+	for (const FIntPoint& PlayerCell : PlayerCells)
 	{
-		GetAllChunkCellsInRadius(CollisionGenerationRadius, PlayerLocation, FoundChunkCells, Missing2DCells);
+		GetAllChunkCellsInRadius(CollisionGenerationRadius, PlayerCell, FoundChunkCells, Missing2DCells);
 
 		{
-			TRACE_CPUPROFILER_EVENT_SCOPE(AChunkManager::AsyncGenerateCollisionForNearbyChunksAndDecompressVoxels);
+			TRACE_CPUPROFILER_EVENT_SCOPE(AChunkManager::AsyncGenerateCollisionForNearbyChunks);
 			// Now it's safe to process OutFoundChunks
 			for (FIntVector& ChunkCell : FoundChunkCells)
 			{
@@ -396,7 +440,7 @@ void AChunkManager::UpateNearbyChunkCollisions()
 		}
 	}
 	{
-		TRACE_CPUPROFILER_EVENT_SCOPE(AChunkManager::GenerateCollisionForNearbyChunksAndDecompressVoxels::GenerateCollision);
+		TRACE_CPUPROFILER_EVENT_SCOPE(AChunkManager::GenerateCollisionForNearbyChunks::GenerateCollision);
 		for (AChunkActor* Chunk : FoundChunks)
 		{
 			if (!Chunk || !IsValid(Chunk))
@@ -408,18 +452,12 @@ void AChunkManager::UpateNearbyChunkCollisions()
 
 		AsyncTask(ENamedThreads::AnyHiPriThreadHiPriTask, [FoundChunks]()
 			{
-				TRACE_CPUPROFILER_EVENT_SCOPE(AChunkManager::GenerateCollisionForNearbyChunksAndDecompressVoxels::GenerateCollisionAsync);
+				TRACE_CPUPROFILER_EVENT_SCOPE(AChunkManager::GenerateCollisionForNearbyChunks::GenerateCollisionAsync);
 
 				for (AChunkActor* Chunk : FoundChunks)
 				{
 					if (Chunk && IsValid(Chunk))
 						Chunk->GenerateChunkCollision();
-
-					if (Chunk->bAreVoxelsCompressed)
-					{
-						Chunk->bAreVoxelsCompressed = false;
-						RunLengthDecode(Chunk->Voxels, Chunk->ChunkCell);
-					}
 				}
 			});
 	}
@@ -433,6 +471,8 @@ void AChunkManager::HandleClientNeededServerData()
 		if (!IsInGameThread())
 			RegionMutex.Lock();
 
+		TArray<FIntPoint> RegionsToSend{}; // Sent once the RegionMutex is released, since sending reads region files
+
 		if (GetNetMode() == ENetMode::NM_DedicatedServer || GetNetMode() == ENetMode::NM_ListenServer)
 		{
 			for (APlayerController* PlayerController : TrackedPlayers)
@@ -456,11 +496,12 @@ void AChunkManager::HandleClientNeededServerData()
 				{
 					FIntPoint Region{ (*RegionsPendingData)[RegionIndex] };
 					if (RegionsAlreadyLoaded.Contains(Region))
-						SendNeededRegionDataOnGameThread(Region);
+						RegionsToSend.AddUnique(Region);
 					else if (!RegionsPendingLoad.Contains(Region))
 					{   // This likely indicate some flaw in our logic, but isn't necessarily a problem
 						//UE_LOG(LogTemp, Warning, TEXT("Region %s was not loaded yet. And not pending load. Adding to pending load"), *Region.ToString());
 						RegionsPendingLoad.Add(Region);
+						ChunkJobQueue.WakeWorkers(); // The first ChunkThread loads pending regions
 					} //else 
 						//UE_LOG(LogTemp, Warning, TEXT("Region %s is pending load when the client needs it. If this message persists, we may not be loading when we should."), *Region.ToString());
 				}
@@ -475,6 +516,9 @@ void AChunkManager::HandleClientNeededServerData()
 		}
 
 		RegionMutex.Unlock();
+
+		for (const FIntPoint& Region : RegionsToSend)
+			SendNeededRegionDataOnGameThread(Region);
 	}
 	else if (IsInGameThread()) // If we are in the game thread and couldn't get an immediate lock
 	{
@@ -501,6 +545,82 @@ void AChunkManager::DequeueAndDestroyChunks()
 	}
 }
 
+void AChunkManager::EnqueueChunksToSpawn(TArray<TSharedPtr<FChunkConstructionData>>& ChunkConstructionDataArray)
+{
+	FScopeLock Lock(&ChunkSpawnQueueMutex);
+	ChunkSpawnQueue.Append(MoveTemp(ChunkConstructionDataArray));
+	ChunkConstructionDataArray.Empty();
+}
+
+void AChunkManager::SpawnQueuedChunks(bool bDidTrackedLocationsChange)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(AChunkManager::SpawnQueuedChunks);
+
+	bool bShouldSort{ bDidTrackedLocationsChange };
+	{
+		FScopeLock Lock(&ChunkSpawnQueueMutex);
+		if (!ChunkSpawnQueue.IsEmpty())
+		{
+			PendingChunkSpawns.Append(MoveTemp(ChunkSpawnQueue));
+			ChunkSpawnQueue.Empty();
+			bShouldSort = true;
+		}
+	}
+
+	if (PendingChunkSpawns.IsEmpty() || !ChunkThreads.IsValidIndex(0) || !ChunkThreads[0])
+		return;
+
+	if (bShouldSort)
+		SortPendingChunkSpawns();
+
+	// Spawning a chunk means creating an actor and uploading its mesh, so we spend a fixed slice of each tick on it instead of letting every finished heightmap land on the same frame
+	const double BudgetEndTime{ FPlatformTime::Seconds() + ChunkSpawnBudgetMs / 1000.0 };
+	const int32 SpawnChunkRadius{ FMath::Max(ChunkGenerationRadius, CollisionGenerationRadius) };
+	do
+	{
+		TSharedPtr<FChunkConstructionData> ChunkConstructionData{ PendingChunkSpawns.Pop(EAllowShrinking::No) };
+		if (!ChunkConstructionData.IsValid() || ChunkConstructionData->IsCancelled()) // UpdateChunks has already released cancelled columns
+			continue;
+
+		ChunkThreads[0]->SpawnChunkFromConstructionData(ChunkConstructionData, SpawnChunkRadius, CollisionGenerationRadius);
+	} while (!PendingChunkSpawns.IsEmpty() && FPlatformTime::Seconds() < BudgetEndTime);
+}
+
+void AChunkManager::SortPendingChunkSpawns()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(AChunkManager::SortPendingChunkSpawns);
+
+	if (PlayerCells.IsEmpty())
+		return;
+
+	// Farthest first so the nearest chunk can be popped off the end
+	auto GetDistanceToNearestPlayerSquared = [this](const TSharedPtr<FChunkConstructionData>& ChunkConstructionData)
+		{
+			if (!ChunkConstructionData.IsValid())
+				return TNumericLimits<double>::Max();
+
+			const FIntPoint ChunkCell2D{ ChunkConstructionData->Cell.X, ChunkConstructionData->Cell.Y };
+			double NearestDistanceSquared{ TNumericLimits<double>::Max() };
+			for (const FIntPoint& PlayerCell : PlayerCells)
+				NearestDistanceSquared = FMath::Min(NearestDistanceSquared, static_cast<double>(FChunkThread::GetDistanceInChunksSquared(ChunkCell2D, PlayerCell)));
+			return NearestDistanceSquared;
+		};
+
+	TArray<TPair<double, TSharedPtr<FChunkConstructionData>>> SortableChunks{};
+	SortableChunks.Reserve(PendingChunkSpawns.Num());
+	for (TSharedPtr<FChunkConstructionData>& ChunkConstructionData : PendingChunkSpawns)
+		SortableChunks.Emplace(GetDistanceToNearestPlayerSquared(ChunkConstructionData), MoveTemp(ChunkConstructionData));
+
+	SortableChunks.Sort([](const TPair<double, TSharedPtr<FChunkConstructionData>>& LHS, const TPair<double, TSharedPtr<FChunkConstructionData>>& RHS)
+		{
+			return LHS.Key > RHS.Key;
+		});
+
+	PendingChunkSpawns.Reset();
+	for (TPair<double, TSharedPtr<FChunkConstructionData>>& SortableChunk : SortableChunks)
+		PendingChunkSpawns.Add(MoveTemp(SortableChunk.Value));
+}
+
 void AChunkManager::UpdateRegionsAsync(bool bForceUpdate)
 {
 	AsyncTask(ENamedThreads::AnyNormalThreadHiPriTask, [this]()
@@ -521,13 +641,6 @@ void AChunkManager::SetVoxel(FVector VoxelWorldLocation, int32 VoxelValue, const
 		UE_LOG(LogTemp, Error, TEXT("Chunk at cell '%s' not found."), *ChunkCell.ToString());
 		return;
 	}
-	if (Chunk->bAreVoxelsCompressed) // Ideally this will happen on the ChunkThread, but if it doesn't, we need to decompress the voxels here
-	{
-		UE_LOG(LogTemp, Warning, TEXT("SetVoxel() Voxels for Cell were compressed when we needed them, so we are decompressing them on the game thread"));
-		RunLengthDecode(Chunk->Voxels, ChunkCell);
-		Chunk->bAreVoxelsCompressed = false;
-	}
-
 	FIntVector VoxelIntPosition;
 	int32 VoxelIndex{ GetVoxelIndex(GetLocationFromChunkCell(ChunkCell, ChunkSize), VoxelWorldLocation, VoxelIntPosition) };
 	if (!Chunk->Voxels.IsValidIndex(VoxelIndex))
@@ -535,12 +648,12 @@ void AChunkManager::SetVoxel(FVector VoxelWorldLocation, int32 VoxelValue, const
 		UE_LOG(LogTemp, Error, TEXT("VoxelIndex %i was OOB of Voxels.Num() %i"), VoxelIndex, Chunk->Voxels.Num());
 		return;
 	}
-	Chunk->Voxels[VoxelIndex] = VoxelValue;
+	Chunk->Voxels.SetVoxel(VoxelIndex, VoxelValue);
 
 	if (bSetVoxelInAdjacentChunk)
 		SetBorderVoxels(VoxelIntPosition, VoxelWorldLocation, VoxelValue, ChunkCell);
 
-	UpdateChunkMesh(Chunk);
+	MarkChunkSlabsDirty(ChunkCell, GetSlabsTouchingVoxel(VoxelIntPosition.Z));
 	UpdateModifiedVoxels(ChunkCell, VoxelIndex, VoxelValue);
 
 	if (bCheckForMissingAdjacentChunks)
@@ -567,61 +680,362 @@ void AChunkManager::SetBorderVoxels(FIntVector& VoxelIntPosition, const FVector&
 	}
 }
 
-void AChunkManager::UpdateChunkMesh(AChunkActor* Chunk)
+void AChunkManager::MarkChunkSlabsDirty(const FIntVector& ChunkCell, const uint32 Slabs)
 {
-	bool bShouldGenerateCollision{ true };
-	FChunkMeshData ChunkMeshData;
-	if (ChunkThreads.IsValidIndex(0) && ChunkThreads[0])
-		ChunkThreads[0]->GenerateChunkMeshData(ChunkMeshData, Chunk->Voxels, Chunk->ChunkCell, bShouldGenerateCollision);
-	else
+	DirtySlabsByChunkCell.FindOrAdd(ChunkCell) |= Slabs;
+}
+
+void AChunkManager::RemeshDirtyChunks()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(AChunkManager::RemeshDirtyChunks);
+
+	for (const TPair<FIntVector, uint32>& DirtyChunk : DirtySlabsByChunkCell)
+	{
+		AChunkActor* Chunk{ ChunksByCell.FindRef(DirtyChunk.Key) };
+		if (IsValid(Chunk))
+			RemeshChunkAsync(Chunk, DirtyChunk.Value);
+	}
+	DirtySlabsByChunkCell.Reset();
+}
+
+// Meshes a copy of the chunk's voxels on a background thread, then applies the slabs on the game thread if nothing newer was started for them
+void AChunkManager::RemeshChunkAsync(AChunkActor* Chunk, const uint32 SlabsToMesh)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(AChunkManager::RemeshChunkAsync);
+
+	if (!ChunkThreads.IsValidIndex(0) || !ChunkThreads[0])
 	{
 		UE_LOG(LogTemp, Error, TEXT("ChunkThreads[0] was nullptr!")); 
 		return;
 	}
-	TArray<UMaterial*> VoxelMaterials{};
-	GetMaterialsForChunkData(ChunkMeshData.VoxelSections, VoxelMaterials);
+	TArray<uint32> SlabRevisions{};
+	SlabRevisions.SetNumZeroed(GetChunkSlabCount(VoxelCount));
+	for (int32 SlabIndex{}; SlabIndex < SlabRevisions.Num(); SlabIndex++)
+		if (SlabsToMesh & (1u << SlabIndex))
+			SlabRevisions[SlabIndex] = Chunk->StartSlabRemesh(SlabIndex);
 
-	Chunk->GenerateChunkMesh(ChunkMeshData, VoxelMaterials);
+	FChunkThread* ChunkThread{ ChunkThreads[0] };
+	TWeakObjectPtr<AChunkActor> WeakChunk{ Chunk };
+	AsyncTask(ENamedThreads::AnyHiPriThreadNormalTask, [this, ChunkThread, WeakChunk, PackedVoxels = Chunk->Voxels, ChunkCell = Chunk->ChunkCell, SlabsToMesh, SlabRevisions]() mutable
+		{
+			TRACE_CPUPROFILER_EVENT_SCOPE(AChunkManager::RemeshChunkAsync::GenerateMeshData);
+
+			TArray<uint8> Voxels{};
+			PackedVoxels.Unpack(Voxels);
+
+			bool bShouldGenerateCollision{ true };
+			TSharedPtr<TArray<FChunkMeshData>> SlabMeshData{ MakeShared<TArray<FChunkMeshData>>() };
+			ChunkThread->GenerateChunkMeshData(*SlabMeshData, Voxels, ChunkCell, bShouldGenerateCollision, SlabsToMesh);
+
+			AsyncTask(ENamedThreads::GameThread, [this, WeakChunk, ChunkCell, SlabMeshData, SlabRevisions]()
+				{
+					AChunkActor* RemeshedChunk{ WeakChunk.Get() };
+					if (!IsValid(RemeshedChunk) || RemeshedChunk->ChunkCell != ChunkCell)
+						return;
+
+					SlabMeshData->RemoveAll([RemeshedChunk, &SlabRevisions](const FChunkMeshData& ChunkMeshData)
+						{
+							return !SlabRevisions.IsValidIndex(ChunkMeshData.SlabIndex) || !RemeshedChunk->IsSlabRemeshCurrent(ChunkMeshData.SlabIndex, SlabRevisions[ChunkMeshData.SlabIndex]);
+						});
+					ApplySlabMeshData(RemeshedChunk, *SlabMeshData);
+				});
+		});
+}
+
+void AChunkManager::ApplySlabMeshData(AChunkActor* Chunk, TArray<FChunkMeshData>& SlabMeshData)
+{
+	for (FChunkMeshData& ChunkMeshData : SlabMeshData)
+	{
+		TArray<UMaterial*> VoxelMaterials{};
+		GetMaterialsForChunkData(ChunkMeshData.VoxelSections, VoxelMaterials);
+
+		Chunk->GenerateChunkMesh(ChunkMeshData, VoxelMaterials);
+	}
+}
+
+uint32 AChunkManager::GetSlabsTouchingVoxel(const int32 VoxelZ) const
+{
+	// VoxelZ may be -1 or VoxelCount for border voxels, which only touch the first or last slab
+	const int32 MinSlab{ FMath::Max(VoxelZ - 1, 0) / ChunkSlabHeightInVoxels };
+	const int32 MaxSlab{ FMath::Min(VoxelZ + 1, VoxelCount - 1) / ChunkSlabHeightInVoxels };
+	uint32 Slabs{};
+	for (int32 SlabIndex{ MinSlab }; SlabIndex <= MaxSlab; SlabIndex++)
+		Slabs |= 1u << SlabIndex;
+
+	return Slabs;
 }
 
 void AChunkManager::UpdateModifiedVoxels(const FIntVector& ChunkCell, int32 VoxelIndex, int32 VoxelValue)
 {
+	UpdateModifiedVoxels(ChunkCell, TArray<int32>{ VoxelIndex }, TArray<uint8>{ static_cast<uint8>(VoxelValue) });
+}
+
+void AChunkManager::UpdateModifiedVoxels(const FIntVector& ChunkCell, const TArray<int32>& VoxelIndices, const TArray<uint8>& VoxelValues)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(AChunkManager::UpdateModifiedVoxels);
+
+	SetModifiedVoxels(ChunkCell, VoxelIndices, VoxelValues);
+
+	// The voxels are set, then the region is marked, then the edits are journaled. That way a compaction either saves these edits or leaves the region marked for the next one
 	FIntPoint Region{};
 	{
-		Region = GetRegionByLocation(FVector2D(FVector(ChunkCell) * ChunkSize), ChunkSize, RegionSizeInChunks);
+		Region = GetRegionByCell(FIntPoint(ChunkCell.X, ChunkCell.Y), RegionSizeInChunks);
 
 		FScopeLock Lock(&RegionMutex);
 		if (!RegionsChangedSinceLastSave.Contains(Region))
 			RegionsChangedSinceLastSave.Add(Region);
 	}
+
+	if (GetNetMode() != NM_Client)
+		EditJournal.Append(ChunkCell, VoxelIndices, VoxelValues);
+}
+
+void AChunkManager::SetModifiedVoxels(const FIntVector& ChunkCell, const TArray<int32>& VoxelIndices, const TArray<uint8>& VoxelValues)
+{
+	const FIntPoint Region{ GetRegionByCell(FIntPoint(ChunkCell.X, ChunkCell.Y), RegionSizeInChunks) };
+
+	ReadUnreadChunkRecord(ChunkCell); // Otherwise these edits would replace the saved ones instead of adding to them
+
+	FScopeLock Lock(&ModifiedVoxelsMutex);
+	if (FRegionFileState* RegionFile{ RegionFilesByRegion.Find(Region) })
+		RegionFile->DirtyCells.Add(ChunkCell);
+	FModifiedChunkVoxels& ModifiedVoxels{ ModifiedVoxelsByCellByRegion.FindOrAdd(Region).FindOrAdd(ChunkCell) };
+
+	// Update the voxels map for saving later
+	for (int32 EditIndex{}; EditIndex < VoxelIndices.Num(); EditIndex++)
+		ModifiedVoxels.SetVoxel(VoxelIndices[EditIndex], VoxelValues[EditIndex], TotalChunkVoxels);
+}
+
+bool AChunkManager::HasModifiedVoxels(const FIntVector& ChunkCell)
+{
+	const FIntPoint Region{ GetRegionByCell(FIntPoint(ChunkCell.X, ChunkCell.Y), RegionSizeInChunks) };
+
+	FScopeLock Lock(&ModifiedVoxelsMutex);
+	const TMap<FIntVector, FModifiedChunkVoxels>* ModifiedVoxelsByCell{ ModifiedVoxelsByCellByRegion.Find(Region) };
+	if (ModifiedVoxelsByCell && ModifiedVoxelsByCell->Contains(ChunkCell))
+		return true;
+
+	const FRegionFileState* RegionFile{ RegionFilesByRegion.Find(Region) }; // Saved but not read yet
+	return RegionFile && RegionFile->RecordsByCell.Contains(ChunkCell);
+}
+
+bool AChunkManager::ReadUnreadChunkRecord(const FIntVector& ChunkCell)
+{
+	const FIntPoint Region{ GetRegionByCell(FIntPoint(ChunkCell.X, ChunkCell.Y), RegionSizeInChunks) };
+	FString Path{};
+	FRegionFileRecord Record{};
+	if (!FindUnreadChunkRecord(Region, ChunkCell, Path, Record)) // Checked without the RegionFileMutex first, since almost every chunk has either no record or one that was already read
+		return false;
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(AChunkManager::ReadUnreadChunkRecord);
+
+	FScopeLock FileLock(&RegionFileMutex);
+	if (!FindUnreadChunkRecord(Region, ChunkCell, Path, Record)) // Another thread read it, or a save moved it, while we waited
+		return false;
+
+	TArray<uint8> Voxels{};
+	bool bDecoded{};
+	const TMap<FIntVector, FRegionFileRecord> RecordsToRead{ { ChunkCell, Record } };
+	FRegionFile::VisitRecords(Path, RecordsToRead, [&Voxels, &bDecoded](const FIntVector& Cell, TConstArrayView<uint8> RecordData) { bDecoded = FVoxelCodec::Decode(RecordData, Voxels); });
+	if (!bDecoded)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to read the saved voxels for ChunkCell %s"), *ChunkCell.ToString());
+		return false;
+	}
+
+	FScopeLock Lock(&ModifiedVoxelsMutex);
+	TMap<FIntVector, FModifiedChunkVoxels>& ModifiedVoxelsByCell{ ModifiedVoxelsByCellByRegion.FindOrAdd(Region) };
+	if (!ModifiedVoxelsByCell.Contains(ChunkCell))
+		ModifiedVoxelsByCell.Add(ChunkCell, FModifiedChunkVoxels(MoveTemp(Voxels)));
+	return true;
+}
+
+void AChunkManager::ReadUnreadRecordsForRegion(const FIntPoint& Region, TMap<FIntVector, TArray<uint8>>& OutRecordDataByCell)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(AChunkManager::ReadUnreadRecordsForRegion);
+
+	FScopeLock FileLock(&RegionFileMutex);
+	FString Path{};
+	TMap<FIntVector, FRegionFileRecord> UnreadRecordsByCell{};
 	{
 		FScopeLock Lock(&ModifiedVoxelsMutex);
-		TMap<FIntVector, TArray<uint8>>* ModifiedVoxelsByCell{};
-		ModifiedVoxelsByCell = ModifiedVoxelsByCellByRegion.Find(Region);
-		if (ModifiedVoxelsByCell == nullptr)
+		const FRegionFileState* RegionFile{ RegionFilesByRegion.Find(Region) };
+		if (!RegionFile)
+			return;
+
+		const TMap<FIntVector, FModifiedChunkVoxels>* ModifiedVoxelsByCell{ ModifiedVoxelsByCellByRegion.Find(Region) };
+		for (const TPair<FIntVector, FRegionFileRecord>& CellRecordPair : RegionFile->RecordsByCell)
+			if (!ModifiedVoxelsByCell || !ModifiedVoxelsByCell->Contains(CellRecordPair.Key))
+				UnreadRecordsByCell.Add(CellRecordPair.Key, CellRecordPair.Value);
+		Path = RegionFile->Path;
+	}
+
+	if (!FRegionFile::ReadRecords(Path, UnreadRecordsByCell, OutRecordDataByCell))
+		UE_LOG(LogTemp, Error, TEXT("Failed to read the saved voxels for region %s"), *Region.ToString());
+}
+
+bool AChunkManager::FindUnreadChunkRecord(const FIntPoint& Region, const FIntVector& ChunkCell, FString& OutPath, FRegionFileRecord& OutRecord)
+{
+	FScopeLock Lock(&ModifiedVoxelsMutex);
+	const FRegionFileState* RegionFile{ RegionFilesByRegion.Find(Region) };
+	if (!RegionFile)
+		return false;
+
+	const FRegionFileRecord* Record{ RegionFile->RecordsByCell.Find(ChunkCell) };
+	if (!Record)
+		return false;
+
+	const TMap<FIntVector, FModifiedChunkVoxels>* ModifiedVoxelsByCell{ ModifiedVoxelsByCellByRegion.Find(Region) };
+	if (ModifiedVoxelsByCell && ModifiedVoxelsByCell->Contains(ChunkCell))
+		return false;
+
+	OutPath = RegionFile->Path;
+	OutRecord = *Record;
+	return true;
+}
+
+void AChunkManager::SetVoxelsInShape(const FVoxelShapeEdit& ShapeEdit)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(AChunkManager::SetVoxelsInShape);
+
+	TArray<FVector> VoxelLocations{};
+	if (!GetVoxelLocationsInShape(ShapeEdit, VoxelLocations) || VoxelLocations.IsEmpty())
+		return;
+
+	// Group the voxels by every chunk that stores them, including the border copies kept by adjacent chunks
+	TMap<FIntVector, FChunkVoxelEdits> EditsByChunkCell{};
+	TArray<int32> AdjacentChunks{};
+	FVector BoundsMin{ VoxelLocations[0] };
+	FVector BoundsMax{ VoxelLocations[0] };
+	for (const FVector& VoxelLocation : VoxelLocations)
+	{
+		const FIntVector ChunkCell{ GetCellFromChunkLocation(VoxelLocation, ChunkSize) };
+		FIntVector VoxelIntPosition{};
+		AddVoxelEdit(EditsByChunkCell, ChunkCell, VoxelLocation, ShapeEdit.VoxelValue, VoxelIntPosition);
+
+		if (GetVoxelOnBorder(VoxelIntPosition, VoxelCount, AdjacentChunks))
 		{
-			ModifiedVoxelsByCell = new TMap<FIntVector, TArray<uint8>>;
-			ModifiedVoxelsByCellByRegion.Add(Region, *ModifiedVoxelsByCell);
+			FIntVector AdjacentVoxelIntPosition{};
+			for (int32 Index : AdjacentChunks)
+				AddVoxelEdit(EditsByChunkCell, ChunkCell + FaceIntDirections[Index], VoxelLocation, ShapeEdit.VoxelValue, AdjacentVoxelIntPosition);
 		}
 
-		if (ModifiedVoxelsByCell->Contains(ChunkCell))
+		BoundsMin = BoundsMin.ComponentMin(VoxelLocation);
+		BoundsMax = BoundsMax.ComponentMax(VoxelLocation);
+	}
+
+	// Edits to chunks that aren't spawned are still saved, so they show up when the chunk generates
+	for (const TPair<FIntVector, FChunkVoxelEdits>& ChunkEdits : EditsByChunkCell)
+	{
+		ApplyVoxelEditsToChunk(ChunkEdits.Key, ChunkEdits.Value);
+		UpdateModifiedVoxels(ChunkEdits.Key, ChunkEdits.Value.VoxelIndices, ChunkEdits.Value.VoxelValues);
+	}
+
+	// Same as SetVoxel's bCheckForMissingAdjacentChunks, but checked once for the whole shape
+	const FVector Buffer{ AdjacentChunkVoxelBuffer * VoxelSize };
+	const FIntVector MinCell{ GetCellFromChunkLocation(BoundsMin - Buffer, ChunkSize) };
+	const FIntVector MaxCell{ GetCellFromChunkLocation(BoundsMax + Buffer, ChunkSize) };
+	for (int32 X{ MinCell.X }; X <= MaxCell.X; X++)
+	{
+		for (int32 Y{ MinCell.Y }; Y <= MaxCell.Y; Y++)
 		{
-			TArray<uint8>* ModifiedVoxels = ModifiedVoxelsByCell->Find(ChunkCell);
-			// Update the voxels map for saving later	
-			if (ModifiedVoxels && ModifiedVoxels->IsValidIndex(VoxelIndex))
-				(*ModifiedVoxels)[VoxelIndex] = VoxelValue;
+			for (int32 Z{ MinCell.Z }; Z <= MaxCell.Z; Z++)
+			{
+				const FIntVector NeededChunkCell{ X, Y, Z };
+				if (ChunksByCell.Contains(NeededChunkCell))
+					continue;
+
+				const FVector VoxelWorldLocation{ ShapeEdit.Center };
+				const int32 VoxelValue{ ShapeEdit.VoxelValue };
+				AsyncTask(ENamedThreads::AnyHiPriThreadHiPriTask, [VoxelWorldLocation, VoxelValue, NeededChunkCell, this]()
+					{ SpawnAdditionalVerticalChunk(VoxelWorldLocation, VoxelValue, NeededChunkCell); });
+			}
 		}
-		else // Should only need to happen once for a given chunk:
-		{
-			TArray<uint8> NewVoxelsArray{};
-			// Use the max value to represent an unmodified voxel (Can't be 0 because that represents a deleted voxel)
-			NewVoxelsArray.Init(UINT8_MAX, TotalChunkVoxels);
-			if (NewVoxelsArray.IsValidIndex(VoxelIndex))
-				NewVoxelsArray[VoxelIndex] = VoxelValue;
+	}
+}
+
+bool AChunkManager::GetVoxelLocationsInShape(const FVoxelShapeEdit& ShapeEdit, TArray<FVector>& OutVoxelLocations) const
+{
+	const FVector Center{ FVector(ShapeEdit.Center).GridSnap(VoxelSize) };
+	const FVector End{ FVector(ShapeEdit.End).GridSnap(VoxelSize) };
+	const float Radius{ FMath::Max(ShapeEdit.Radius, 0.f) };
+
+	FVector BoundsMin{};
+	FVector BoundsMax{};
+	switch (ShapeEdit.Shape)
+	{
+	case EVoxelEditShape::Box:
+		BoundsMin = Center - FVector(ShapeEdit.Extent).GetAbs();
+		BoundsMax = Center + FVector(ShapeEdit.Extent).GetAbs();
+		break;
+	case EVoxelEditShape::Sphere:
+		BoundsMin = Center - FVector(Radius);
+		BoundsMax = Center + FVector(Radius);
+		break;
+	case EVoxelEditShape::Line:
+		BoundsMin = Center.ComponentMin(End) - FVector(Radius);
+		BoundsMax = Center.ComponentMax(End) + FVector(Radius);
+		break;
+	}
 
-			ModifiedVoxelsByCell->Emplace(ChunkCell, NewVoxelsArray);
+	const FIntVector MinVoxel{ FMath::RoundToInt32(BoundsMin.X / VoxelSize), FMath::RoundToInt32(BoundsMin.Y / VoxelSize), FMath::RoundToInt32(BoundsMin.Z / VoxelSize) };
+	const FIntVector MaxVoxel{ FMath::RoundToInt32(BoundsMax.X / VoxelSize), FMath::RoundToInt32(BoundsMax.Y / VoxelSize), FMath::RoundToInt32(BoundsMax.Z / VoxelSize) };
+	const FIntVector BoundsSize{ MaxVoxel - MinVoxel + FIntVector(1) };
+	const int64 VoxelsInBounds{ static_cast<int64>(BoundsSize.X) * BoundsSize.Y * BoundsSize.Z };
+	if (VoxelsInBounds > MaxVoxelsPerShapeEdit)
+	{
+		UE_LOG(LogTemp, Error, TEXT("SetVoxelsInShape covered %lld voxels. The max is %i"), VoxelsInBounds, MaxVoxelsPerShapeEdit);
+		return false;
+	}
+
+	const float RadiusSquared{ Radius * Radius };
+	const float LineThickness{ FMath::Max(Radius, VoxelSize * 0.5f) }; // A line always covers the voxels it passes through
+	OutVoxelLocations.Reserve(static_cast<int32>(VoxelsInBounds));
+	for (int32 X{ MinVoxel.X }; X <= MaxVoxel.X; X++)
+	{
+		for (int32 Y{ MinVoxel.Y }; Y <= MaxVoxel.Y; Y++)
+		{
+			for (int32 Z{ MinVoxel.Z }; Z <= MaxVoxel.Z; Z++)
+			{
+				const FVector VoxelLocation{ FVector(X, Y, Z) * VoxelSize };
+				bool bIsInShape{ true };
+				if (ShapeEdit.Shape == EVoxelEditShape::Sphere)
+					bIsInShape = FVector::DistSquared(VoxelLocation, Center) <= RadiusSquared;
+				else if (ShapeEdit.Shape == EVoxelEditShape::Line)
+					bIsInShape = FMath::PointDistToSegment(VoxelLocation, Center, End) <= LineThickness;
+
+				if (bIsInShape)
+					OutVoxelLocations.Add(VoxelLocation);
+			}
 		}
 	}
+
+	return true;
+}
+
+void AChunkManager::AddVoxelEdit(TMap<FIntVector, FChunkVoxelEdits>& EditsByChunkCell, const FIntVector& ChunkCell, const FVector& VoxelWorldLocation, uint8 VoxelValue, FIntVector& OutVoxelIntPosition)
+{
+	const int32 VoxelIndex{ GetVoxelIndex(GetLocationFromChunkCell(ChunkCell, ChunkSize), VoxelWorldLocation, OutVoxelIntPosition) };
+	if (VoxelIndex < 0 || VoxelIndex >= TotalChunkVoxels)
+		return;
+
+	FChunkVoxelEdits& ChunkVoxelEdits{ EditsByChunkCell.FindOrAdd(ChunkCell) };
+	ChunkVoxelEdits.VoxelIndices.Add(VoxelIndex);
+	ChunkVoxelEdits.VoxelValues.Add(VoxelValue);
+	ChunkVoxelEdits.DirtySlabs |= GetSlabsTouchingVoxel(OutVoxelIntPosition.Z);
+}
+
+void AChunkManager::ApplyVoxelEditsToChunk(const FIntVector& ChunkCell, const FChunkVoxelEdits& ChunkVoxelEdits)
+{
+	AChunkActor* Chunk{ ChunksByCell.FindRef(ChunkCell) };
+	if (!IsValid(Chunk))
+		return;
+
+	for (int32 EditIndex{}; EditIndex < ChunkVoxelEdits.VoxelIndices.Num(); EditIndex++)
+		if (Chunk->Voxels.IsValidIndex(ChunkVoxelEdits.VoxelIndices[EditIndex]))
+			Chunk->Voxels.SetVoxel(ChunkVoxelEdits.VoxelIndices[EditIndex], ChunkVoxelEdits.VoxelValues[EditIndex]);
+
+	MarkChunkSlabsDirty(ChunkCell, ChunkVoxelEdits.DirtySlabs);
 }
 
 void AChunkManager::CheckForNeededNeighborChunks(FVector VoxelLocation, TArray<FIntVector>& OutNeededChunkCells)
@@ -657,16 +1071,17 @@ void AChunkManager::CheckForNeededNeighborChunks(FVector VoxelLocation, TArray<F
 
 void AChunkManager::SpawnAdditionalVerticalChunk(FVector VoxelWorldLocation, int32 VoxelValue, const FIntVector ChunkCell)
 {
-	FScopeLock Lock(&FChunkThread::ChunkZMutex);
-
-	TArray<int32>* ChunkZIndicesPtr{ FChunkThread::ChunkZIndicesBy2DCell.Find(FIntPoint(ChunkCell.X, ChunkCell.Y)) };
-	if (!ChunkZIndicesPtr || ChunkZIndicesPtr->Contains(ChunkCell.Z))
-	{
-		ChunkZIndicesPtr = nullptr;
+	bool bWasZIndexAdded{};
+	FChunkThread::ChunkZIndicesBy2DCell.ModifyIfFound(FIntPoint(ChunkCell.X, ChunkCell.Y), [&](TArray<int32>& ChunkZIndices)
+		{
+			if (!ChunkZIndices.Contains(ChunkCell.Z))
+			{
+				ChunkZIndices.Add(ChunkCell.Z);
+				bWasZIndexAdded = true;
+			}
+		});
+	if (!bWasZIndexAdded) // The column isn't generated, or the chunk is already there
 		return;
-	}
-	ChunkZIndicesPtr->Add(ChunkCell.Z);
-	Lock.Unlock();
 
 	FVector ChunkLocation{ GetLocationFromChunkCell(ChunkCell, ChunkSize) };
 	bool bChunkNeedsCollision{ true };
@@ -676,19 +1091,22 @@ void AChunkManager::SpawnAdditionalVerticalChunk(FVector VoxelWorldLocation, int
 		FChunkThread* Thread = ChunkThreads[0];
 		TArray<int16> Heightmap{};
 		TArray<int32> UnneededVerticalIndices{};
-		// We could keep the heightmap for this 2D around if we want to avoid recalculating it, but it would take up memory. Since we have a buffer for this, we will probably be fine.
-		Thread->GenerateHeightmap(Heightmap, FVector2D(ChunkLocation), UnneededVerticalIndices);
+		Thread->GetHeightmap(Heightmap, FIntPoint(ChunkCell.X, ChunkCell.Y), UnneededVerticalIndices); // Usually cached from when the column was generated
 		Thread->GenerateChunkVoxels(ChunkConstructionData->Voxels, Heightmap, ChunkLocation);
 		Thread->ApplyModifiedVoxelsToChunk(ChunkConstructionData->Voxels, ChunkCell);
 	}
-	AsyncTask(ENamedThreads::GameThread, [this, ChunkConstructionData, VoxelWorldLocation, VoxelValue, ChunkCell]() mutable
+	const bool bWasChunkModified{ HasModifiedVoxels(ChunkCell) };
+	AsyncTask(ENamedThreads::GameThread, [this, ChunkConstructionData, VoxelWorldLocation, VoxelValue, ChunkCell, bWasChunkModified]() mutable
 		{
 			bool bShouldGenerateMesh{ false };
 			if (ChunkThreads.IsValidIndex(0) && ChunkThreads[0])
 				ChunkThreads[0]->SpawnChunkFromConstructionData(MoveTemp(ChunkConstructionData), ChunkGenerationRadius, CollisionGenerationRadius, bShouldGenerateMesh);
 
+			if (bWasChunkModified) // Shape edits can reach into chunks before they spawn, so those need meshing now
+				MarkChunkSlabsDirty(ChunkCell, AllChunkSlabs);
+
 			if (GetNetMode() == NM_DedicatedServer || GetNetMode() == NM_ListenServer)
-				ReplicateChunkNamesAsync(FVector2D(GetLocationFromChunkCell(ChunkCell, ChunkSize)));
+				ReplicateChunkNamesAsync(FIntPoint(ChunkCell.X, ChunkCell.Y));
 		});
 }
 
@@ -731,13 +1149,13 @@ const int32 AChunkManager::GetVoxel(FVector VoxelWorldLocation, FIntVector Chunk
 	FIntVector OutVoxelIntPosition{};
 	int32 VoxelIndex = GetVoxelIndex(Chunk->GetActorLocation(), VoxelWorldLocation, OutVoxelIntPosition);
 
-	if (VoxelIndex < 0 || VoxelIndex >= Chunk->Voxels.Num())
+	if (!Chunk->Voxels.IsValidIndex(VoxelIndex))
 	{
 		UE_LOG(LogTemp, Error, TEXT("GetVoxel: Voxel index %i out of bounds of array with num %i."), VoxelIndex, Chunk->Voxels.Num());
 		return -1;
 	}
 
-	return Chunk->Voxels[VoxelIndex];
+	return Chunk->Voxels.GetVoxel(VoxelIndex);
 }
 
 void AChunkManager::SetSaveGameName(const FString& NewWorldSaveName)
@@ -776,6 +1194,7 @@ void AChunkManager::SetChunkGenerationRadius(int32 GenDistance)
 			ChunkThread->SetChunkGenRadius(GenDistance);
 
 	bWasGenRangeChanged = true;
+	ChunkJobQueue.WakeWorkers();
 }
 
 bool AChunkManager::AddTrackedPlayer(APlayerController* TrackedPlayer, bool bShouldInsertAtFront)
@@ -799,7 +1218,7 @@ bool AChunkManager::AddTrackedPlayer(APlayerController* TrackedPlayer, bool bSho
 	TrackedRegionsByPlayer.Add(TPair<APlayerController*, TArray<FIntPoint>>(TrackedPlayer, TArray<FIntPoint>()));
 	TrackedChunkNamesUpToDate.Add(TrackedPlayer, TArray<FIntVector>());
 	TrackedPlayers.Add(TrackedPlayer);
-	TrackedHasFoundChunkInSpawnLocation.Add(IsChunkGeneratedInThis2DLocation(FVector2D(TrackedPlayer->GetPawn()->GetActorLocation())));
+	TrackedHasFoundChunkInSpawnLocation.Add(IsChunkGeneratedInThis2DCell(Get2DCellFromLocation(TrackedPlayer->GetPawn()->GetActorLocation(), ChunkSize)));
 
 	if (GetNetMode() == ENetMode::NM_DedicatedServer || GetNetMode() == ENetMode::NM_ListenServer)
 	{
@@ -836,6 +1255,11 @@ void AChunkManager::ImplementTerrainSettings(FTerrainSettings& NewTerrainSetting
 	CollisionGenerationRadius = NewTerrainSettings.CollisionGenerationRadius;
 	VoxelSize = NewTerrainSettings.VoxelSize;
 	VoxelCount = NewTerrainSettings.VoxelCount;
+	if (VoxelCount > MaxChunkVoxelCount)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("VoxelCount of %i is larger than the max of %i. Clamping it"), VoxelCount, MaxChunkVoxelCount);
+		VoxelCount = MaxChunkVoxelCount;
+	}
 	ChunkSize = VoxelCount * VoxelSize;
 	TotalChunkVoxels = FMath::Pow((VoxelCount + 2.0f), 3.0f);
 }
@@ -845,20 +1269,27 @@ void AChunkManager::RemoveTrackedPlayer(APlayerController* TrackedPlayer)
 	int32 RemovalIndex{ TrackedPlayers.Find(TrackedPlayer) };
 	TrackedPlayers.Remove(TrackedPlayer);
 	TrackedHasFoundChunkInSpawnLocation.RemoveAt(RemovalIndex);
-	PlayerLocations.RemoveAt(RemovalIndex);
+	PlayerCells.RemoveAt(RemovalIndex);
+	if (PlayerViewDirections.IsValidIndex(RemovalIndex))
+		PlayerViewDirections.RemoveAt(RemovalIndex);
+	if (PlayerVelocities.IsValidIndex(RemovalIndex))
+		PlayerVelocities.RemoveAt(RemovalIndex);
+	if (PredictedPlayerCells.IsValidIndex(RemovalIndex))
+		PredictedPlayerCells.RemoveAt(RemovalIndex);
 	TrackedChunkNamesUpToDate.Remove(TrackedPlayer);
 	TrackedRegionsByPlayer.Remove(TrackedPlayer);
 	TrackedRegionsPendingServerData.Remove(TrackedPlayer);
 	TrackedRegionsThatHaveServerData.Remove(TrackedPlayer);
 }
 
-void AChunkManager::ReplicateChunkNamesAsync(const FVector2D& PlayerLocation)
+void AChunkManager::ReplicateChunkNamesAsync(const FIntPoint& PlayerCell2D)
 {
+	const FIntVector CenterCell{ PlayerCell2D.X, PlayerCell2D.Y, 0 };
 	if (!IsInGameThread())
-		ReplicateChunkNames(GetCellFromChunkLocation(FVector(PlayerLocation, 0), ChunkSize));
+		ReplicateChunkNames(CenterCell);
 	else
-		AsyncTask(ENamedThreads::AnyNormalThreadHiPriTask, [PlayerLocation, this]()
-			{ ReplicateChunkNames(GetCellFromChunkLocation(FVector(PlayerLocation, 0), ChunkSize)); });
+		AsyncTask(ENamedThreads::AnyNormalThreadHiPriTask, [CenterCell, this]()
+			{ ReplicateChunkNames(CenterCell); });
 }
 
 // Runs on a thread, Do not call manually
@@ -866,6 +1297,7 @@ bool AChunkManager::UpdateRegionVariables()
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(AChunkManager::UpdateRegionVariables);
 	bool bWereRegionsChanged{};
+	bool bWereRegionsAddedOrRemoved{};
 
 	TArray<APlayerController*> PlayerControllers{};
 	TrackedRegionsByPlayer.GetKeys(PlayerControllers);
@@ -876,8 +1308,8 @@ bool AChunkManager::UpdateRegionVariables()
 			UE_LOG(LogTemp, Error, TEXT("PlayerController or Pawn was invalid when updating Regions!"));
 			continue;
 		}
-		FVector2D CurrentActorLocation{ FVector2D(GetChunkGridLocation(PlayerController->GetPawn()->GetActorLocation(), ChunkSize)) };
-		FIntPoint CenterRegion{ GetRegionByLocation(CurrentActorLocation, ChunkSize, RegionSizeInChunks) };
+		FIntPoint CurrentActorCell{ Get2DCellFromLocation(PlayerController->GetPawn()->GetActorLocation(), ChunkSize) };
+		FIntPoint CenterRegion{ GetRegionByCell(CurrentActorCell, RegionSizeInChunks) };
 
 		bWereRegionsChanged = TrackedRegionsByPlayer.Contains(PlayerController);
 		TArray<FIntPoint> TrackedRegions{ TrackedRegionsByPlayer.FindOrAdd(PlayerController) };
@@ -885,7 +1317,10 @@ bool AChunkManager::UpdateRegionVariables()
 
 		CalculateNeededRegions(CenterRegion, TrackedRegions);
 		if (OldRegions != TrackedRegions)
+		{
 			bWereRegionsChanged = true;
+			bWereRegionsAddedOrRemoved = true;
+		}
 
 		FScopeLock Lock(&RegionMutex);
 
@@ -901,6 +1336,9 @@ bool AChunkManager::UpdateRegionVariables()
 		TrackedRegionsByPlayer.FindRef(PlayerController) = TrackedRegions;
 	}
 
+	if (bWereRegionsAddedOrRemoved)
+		ChunkJobQueue.WakeWorkers(); // The first ChunkThread loads and saves the pending regions
+
 	return bWereRegionsChanged;
 }
 
@@ -991,6 +1429,7 @@ void AChunkManager::SendNeededRegionData(const FIntPoint& Region)
 {
 	TArray<APlayerController*> PlayerControllers{};
 	TrackedRegionsByPlayer.GetKeys(PlayerControllers);
+	TOptional<FRegionData> EncodedRegionData{}; // Encoded the first time a client needs it, then shared by every client
 	for (APlayerController* PlayerController: PlayerControllers)
 	{
 		if (!PlayerController || !PlayerController->IsValidLowLevel())
@@ -1008,42 +1447,52 @@ void AChunkManager::SendNeededRegionData(const FIntPoint& Region)
 
 			continue;
 		}
-		FScopeLock RegionLock(&RegionMutex);
-		if (GetDoesClientHaveRegionData(PlayerController, Region))
-			continue;
-
-		UChunkModifierComponent* ChunkModifierComponent = PlayerController->FindComponentByClass<UChunkModifierComponent>();
-		if (!ChunkModifierComponent)
+		UChunkModifierComponent* ChunkModifierComponent{};
 		{
-			UE_LOG(LogTemp, Error, TEXT("ChunkModifierComponent was nullptr, so we can't send region data!"));
-			continue;
-		}
-
-		TrackedRegionsThatHaveServerData.FindOrAdd(PlayerController).Add(Region);
-		if (TrackedRegionsPendingServerData.Contains(PlayerController))
-			TrackedRegionsPendingServerData.Find(PlayerController)->Remove(Region);
+			FScopeLock RegionLock(&RegionMutex); // Released before encoding, since reading the region's records takes the RegionFileMutex
+			if (GetDoesClientHaveRegionData(PlayerController, Region))
+				continue;
 
-		FRegionData RegionData{};
-		RegionData.Region = Region;
+			ChunkModifierComponent = PlayerController->FindComponentByClass<UChunkModifierComponent>();
+			if (!ChunkModifierComponent)
+			{
+				UE_LOG(LogTemp, Error, TEXT("ChunkModifierComponent was nullptr, so we can't send region data!"));
+				continue;
+			}
 
-		FScopeLock Lock(&ModifiedVoxelsMutex);
-		if (!ModifiedVoxelsByCellByRegion.Contains(Region)) // This is fine. It just means there were no modified voxels here. We still want to send the empty region data to the client so it knows it's up to date
-		{
-			bool bIsLastBundle{ true };
-			ChunkModifierComponent->ClientReceiveRegionData(RegionData, bIsLastBundle);
-			continue;
+			TrackedRegionsThatHaveServerData.FindOrAdd(PlayerController).Add(Region);
+			if (TrackedRegionsPendingServerData.Contains(PlayerController))
+				TrackedRegionsPendingServerData.Find(PlayerController)->Remove(Region);
 		}
 
-		TMap<FIntVector, TArray<uint8>>& ModifiedVoxelsByCell{ *ModifiedVoxelsByCellByRegion.Find(Region) };
-		for (TPair<FIntVector, TArray<uint8>>& CellVoxelPair : ModifiedVoxelsByCell)
+		if (!EncodedRegionData.IsSet())
 		{
-			FIntVector Cell{ CellVoxelPair.Key };
-			TArray<uint8> CompressedVoxels{ CellVoxelPair.Value }; // We make a copy so we don't modify the original data
-			RunLengthEncode(CompressedVoxels, Cell);
-			RegionData.EncodedVoxelsArrays.Add(FEncodedVoxelData{ Cell, MoveTemp(CompressedVoxels) });
+			EncodedRegionData.Emplace();
+			EncodedRegionData->Region = Region;
+
+			TMap<FIntVector, TArray<uint8>> UnreadRecordDataByCell{}; // Records use the same FVoxelCodec encoding clients expect, so they can be sent without decoding them
+			ReadUnreadRecordsForRegion(Region, UnreadRecordDataByCell);
+
+			FScopeLock Lock(&ModifiedVoxelsMutex);
+			const TMap<FIntVector, FModifiedChunkVoxels>* ModifiedVoxelsByCell{ ModifiedVoxelsByCellByRegion.Find(Region) };
+			if (ModifiedVoxelsByCell)
+			{
+				TArray<uint8> Voxels{};
+				for (const TPair<FIntVector, FModifiedChunkVoxels>& CellVoxelPair : *ModifiedVoxelsByCell)
+				{
+					CellVoxelPair.Value.ToDense(Voxels, TotalChunkVoxels); // Clients expect the full array layout
+					TArray<uint8> CompressedVoxels{};
+					FVoxelCodec::Encode(Voxels, CompressedVoxels, true); // We are on the game thread, so skip the slower codecs saves use
+					EncodedRegionData->EncodedVoxelsArrays.Add(FEncodedVoxelData{ CellVoxelPair.Key, MoveTemp(CompressedVoxels) });
+				}
+			}
+			for (TPair<FIntVector, TArray<uint8>>& CellRecordPair : UnreadRecordDataByCell)
+				if (!ModifiedVoxelsByCell || !ModifiedVoxelsByCell->Contains(CellRecordPair.Key)) // Read by a ChunkThread since we copied it, so it may have been edited
+					EncodedRegionData->EncodedVoxelsArrays.Add(FEncodedVoxelData{ CellRecordPair.Key, MoveTemp(CellRecordPair.Value) });
 		}
+		FRegionData RegionData{ EncodedRegionData.GetValue() };
 
-		if (RegionData.EncodedVoxelsArrays.IsEmpty()) // This probably won't happen, but it's fine. We still want to send the empty region data to the client so it knows it's up to date
+		if (RegionData.EncodedVoxelsArrays.IsEmpty()) // This is fine. It just means there were no modified voxels here. We still want to send the empty region data to the client so it knows it's up to date
 		{
 			bool bIsLastBundle{ true };
 			ChunkModifierComponent->ClientReceiveRegionData(RegionData, bIsLastBundle);
@@ -1107,18 +1556,19 @@ void AChunkManager::ImplementRegionData(FRegionData RegionData)
 			}
 			if (bModifiedVoxelsDoesNotContainRegion)
 			{
-				TMap<FIntVector, TArray<uint8>> ModifiedVoxelsByCell{};
+				TMap<FIntVector, FModifiedChunkVoxels> ModifiedVoxelsByCell{};
 				for (FEncodedVoxelData& EncodedVoxelData : RegionData.EncodedVoxelsArrays)
 				{
-					RunLengthDecode(EncodedVoxelData.Voxels, EncodedVoxelData.ChunkCell);
-					ModifiedVoxelsByCell.Add(EncodedVoxelData.ChunkCell, MoveTemp(EncodedVoxelData.Voxels));
-					FScopeLock ZMutexLock(&FChunkThread::ChunkZMutex);
-					FChunkThread::ModifiedAdditionalChunkZIndicesBy2DCell.FindOrAdd(FIntPoint(EncodedVoxelData.ChunkCell.X, EncodedVoxelData.ChunkCell.Y)).Add(EncodedVoxelData.ChunkCell.Z);
+					TArray<uint8> Voxels{};
+					if (!FVoxelCodec::Decode(EncodedVoxelData.Voxels, Voxels))
+						continue;
+					ModifiedVoxelsByCell.Add(EncodedVoxelData.ChunkCell, FModifiedChunkVoxels(MoveTemp(Voxels)));
+					FChunkThread::ModifiedAdditionalChunkZIndicesBy2DCell.Modify(FIntPoint(EncodedVoxelData.ChunkCell.X, EncodedVoxelData.ChunkCell.Y), [&EncodedVoxelData](TArray<int32>& ZIndices) { ZIndices.Add(EncodedVoxelData.ChunkCell.Z); });
 				}
 
 				{
 					FScopeLock Lock(&ModifiedVoxelsMutex);
-					ModifiedVoxelsByCellByRegion.Add(RegionData.Region, ModifiedVoxelsByCell);
+					ModifiedVoxelsByCellByRegion.Add(RegionData.Region, MoveTemp(ModifiedVoxelsByCell));
 				}
 				AddToRegionsThatHaveData(RegionData.Region);
 
@@ -1127,7 +1577,7 @@ void AChunkManager::ImplementRegionData(FRegionData RegionData)
 
 			{
 				FScopeLock Lock(&ModifiedVoxelsMutex);
-				TMap<FIntVector, TArray<uint8>>* ModifiedVoxelsByCell{ ModifiedVoxelsByCellByRegion.Find(RegionData.Region) };
+				TMap<FIntVector, FModifiedChunkVoxels>* ModifiedVoxelsByCell{ ModifiedVoxelsByCellByRegion.Find(RegionData.Region) };
 				if (ModifiedVoxelsByCell == nullptr)
 				{
 					UE_LOG(LogTemp, Error, TEXT("ModifiedVoxelsByCell was nullptr!"));
@@ -1137,12 +1587,11 @@ void AChunkManager::ImplementRegionData(FRegionData RegionData)
 				}
 				for (FEncodedVoxelData& EncodedVoxelData : RegionData.EncodedVoxelsArrays)
 				{
-					RunLengthDecode(EncodedVoxelData.Voxels, EncodedVoxelData.ChunkCell);
-					ModifiedVoxelsByCell->Add(EncodedVoxelData.ChunkCell, MoveTemp(EncodedVoxelData.Voxels));
-					{
-						FScopeLock ZMutexLock(&FChunkThread::ChunkZMutex);
-						FChunkThread::ModifiedAdditionalChunkZIndicesBy2DCell.FindOrAdd(FIntPoint(EncodedVoxelData.ChunkCell.X, EncodedVoxelData.ChunkCell.Y)).Add(EncodedVoxelData.ChunkCell.Z);
-					}
+					TArray<uint8> Voxels{};
+					if (!FVoxelCodec::Decode(EncodedVoxelData.Voxels, Voxels))
+						continue;
+					ModifiedVoxelsByCell->Add(EncodedVoxelData.ChunkCell, FModifiedChunkVoxels(MoveTemp(Voxels)));
+					FChunkThread::ModifiedAdditionalChunkZIndicesBy2DCell.Modify(FIntPoint(EncodedVoxelData.ChunkCell.X, EncodedVoxelData.ChunkCell.Y), [&EncodedVoxelData](TArray<int32>& ZIndices) { ZIndices.Add(EncodedVoxelData.ChunkCell.Z); });
 				}
 			}
 			AddToRegionsThatHaveData(RegionData.Region);
@@ -1156,22 +1605,21 @@ void AChunkManager::AddToRegionsThatHaveData(FIntPoint Region)
 	if (RegionsPendingData)
 		RegionsPendingData->Remove(Region);
 	TrackedRegionsThatHaveServerData.FindOrAdd(nullptr).Add(Region);
+	Lock.Unlock();
+
+	ChunkJobQueue.ReleaseDeferredJobs(); // Jobs in this region were waiting on its data
 }
 
 // This multicast event is called on the server when a client moves a chunk
-void AChunkManager::ReplicatePlayerChunkLocations_Implementation(const TArray<FVector2D>& Player2DCells)
+void AChunkManager::ReplicatePlayerChunkLocations_Implementation(const TArray<FIntPoint>& Player2DCells)
 {
-	TArray<FVector2D> TrackedPlayerLocations{};
-	for (const FVector2D& PlayerChunkCell2D : Player2DCells)
-		TrackedPlayerLocations.Emplace(GetLocationFromChunkCell(FIntVector(PlayerChunkCell2D.X, PlayerChunkCell2D.Y, 0), ChunkSize));
-
 	TArray<FIntPoint> AllHeightmapCells{};
 	AllHeightmapCells.Reserve(ChunksByCell.Num());
 	for (const TPair<FIntVector, AChunkActor*>& CellChunkPair : ChunksByCell)
 	{
 		if (ChunkThreads.IsValidIndex(0) && ChunkThreads[0])
 		{
-			if (!ChunkThreads[0]->DoesLocationNeedCollision(FVector2D(GetLocationFromChunkCell(FIntVector(CellChunkPair.Key.X, CellChunkPair.Key.Y, 0), ChunkSize)), TrackedPlayerLocations, CollisionGenerationRadius + ChunkDeletionBuffer))
+			if (!ChunkThreads[0]->DoesCellNeedCollision(FIntPoint(CellChunkPair.Key.X, CellChunkPair.Key.Y), Player2DCells, CollisionGenerationRadius + ChunkDeletionBuffer))
 				CellChunkPair.Value->bIsSafeToDestroy = true;
 			else
 				CellChunkPair.Value->bIsSafeToDestroy = false;
@@ -1219,7 +1667,34 @@ void AChunkManager::DestroyChunk(FIntVector& ChunkCell)
 		return;
 	}
 
-	Chunk->Destroy();
+	if (!ReleaseChunkToPool(Chunk))
+		Chunk->Destroy();
+}
+
+// Returns false if the chunk can't be pooled and should be destroyed instead
+bool AChunkManager::ReleaseChunkToPool(AChunkActor* Chunk)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(AChunkManager::ReleaseChunkToPool);
+
+	// Replicated chunks have a name tied to their cell and a channel on every client, so those always get destroyed and respawned with a fresh name
+	if (PooledChunks.Num() >= MaxPooledChunkActors || Chunk->GetIsReplicated() || Chunk->bHasReplicatedName)
+		return false;
+
+	Chunk->ResetForPool();
+	PooledChunks.Add(Chunk);
+	return true;
+}
+
+// Returns nullptr if the pool is empty
+AChunkActor* AChunkManager::TakePooledChunk()
+{
+	while (!PooledChunks.IsEmpty())
+	{
+		AChunkActor* Chunk{ PooledChunks.Pop(EAllowShrinking::No) };
+		if (IsValid(Chunk))
+			return Chunk;
+	}
+	return nullptr;
 }
 
 int32 MaxChunkRetryCount{50};
@@ -1242,7 +1717,7 @@ void AChunkManager::ReplicateChunkNames(FIntVector CenterCell, bool bEnsureNoneM
 		UE_LOG(LogTemp, Error, TEXT("ChunkThreads[0] was nullptr!"));
 		return;
 	}
-	GetAllChunkCellsInRadius(CollisionGenerationRadius, FVector2D(GetLocationFromChunkCell(CenterCell, ChunkSize)), FoundChunkCells, MissingCells2D);
+	GetAllChunkCellsInRadius(CollisionGenerationRadius, FIntPoint(CenterCell.X, CenterCell.Y), FoundChunkCells, MissingCells2D);
 	bWereAnyChunksMissing = !MissingCells2D.IsEmpty();
 
 	// if any chunks were missing, set a timer to try again:
@@ -1299,59 +1774,25 @@ void AChunkManager::ReplicateChunkNames(FIntVector CenterCell, bool bEnsureNoneM
 	return;
 }
 
-void AChunkManager::GetAllChunkCellsInRadius(int32 SearchRadius, const FVector2D& TrackedLocation, TArray<FIntVector>& OutFoundChunkCells, TArray<FIntPoint>& OutMissing2DCells)
+void AChunkManager::GetAllChunkCellsInRadius(int32 SearchRadius, const FIntPoint& CenterCell2D, TArray<FIntVector>& OutFoundChunkCells, TArray<FIntPoint>& OutMissing2DCells)
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(AChunkManager::GetAllChunkCellsInRadius);
 
-	int32 SearchRingChunkDistance{};
-	int32 SearchChunkAngleIndex{};
-	int32 SearchRingCount{};
-	int32 SearchLastRingCount{};
-	int32 SearchCirumferenceInChunks{};
 	OutFoundChunkCells.Empty();
 	OutMissing2DCells.Empty();
-	FVector2D TrackedGridLocation{ FChunkThread::GetLocationSnappedToChunkGrid2D(TrackedLocation, ChunkSize) };
-	while (SearchRingChunkDistance < SearchRadius) // Loop until we find a needed heightmap or we reach the edge of the generation radius
+	TSharedPtr<const TArray<FIntPoint>> SpiralOffsets{ FChunkThread::GetSpiralOffsets(SearchRadius) };
+	for (const FIntPoint& Offset : *SpiralOffsets) // Each offset is unique, so each cell is only visited once
 	{
-		if (SearchLastRingCount != SearchRingCount) // If the radius has changed
+		FIntPoint ChunkCell2D{ CenterCell2D + Offset };
+		TArray<int32>* TerrainZIndices{ ChunkZIndicesBy2DCell.Find(ChunkCell2D) };
+		if (!TerrainZIndices)
 		{
-			SearchCirumferenceInChunks = FMath::Max(FChunkThread::CalculateCircumferenceInChunks(SearchRingCount, ChunkSize), 1);
-			SearchChunkAngleIndex = 0;
-		}
-		SearchLastRingCount = SearchRingCount;
-
-		while (SearchChunkAngleIndex < SearchCirumferenceInChunks)
-		{
-			float ChunkYawAngle = (360.f / SearchCirumferenceInChunks) * SearchChunkAngleIndex;
-			FVector2D HeightmapLocation = FVector2D(FChunkThread::GetLocationSnappedToChunkGrid2D(TrackedGridLocation + FVector2D(FRotator(0, ChunkYawAngle, 0).Vector()) * (FVector2D(ChunkSize) * SearchRingCount / 2.0), ChunkSize));
-
-			if (SearchChunkAngleIndex <= 0)
-			{
-				int32 ManhattanDistance = FMath::Abs(TrackedGridLocation.X - HeightmapLocation.X) + FMath::Abs(TrackedGridLocation.Y - HeightmapLocation.Y);
-				SearchRingChunkDistance = FMath::Abs(FMath::RoundToInt32(ManhattanDistance / ChunkSize));
-			}
-
-			FIntPoint ChunkCell2D{ AChunkManager::Get2DCellFromChunkLocation2D(HeightmapLocation, ChunkSize) };
-
-			if (!ChunkZIndicesBy2DCell.Contains(ChunkCell2D))
-			{
-				OutMissing2DCells.Add(ChunkCell2D);
-				SearchChunkAngleIndex++;
-				continue;
-			}
-			TArray<int32>& TerrainZIndices{ *ChunkZIndicesBy2DCell.Find(ChunkCell2D) };
-			for (int32 ZIndex : TerrainZIndices)
-			{
-				FIntVector ChunkCell{ ChunkCell2D.X, ChunkCell2D.Y, ZIndex };
-				if (!OutFoundChunkCells.Contains(ChunkCell))
-					OutFoundChunkCells.Emplace(ChunkCell);
-			}
-
-			SearchChunkAngleIndex++;
+			OutMissing2DCells.Add(ChunkCell2D);
+			continue;
 		}
 
-		if (SearchChunkAngleIndex >= SearchCirumferenceInChunks)
-			SearchRingCount++;
+		for (int32 ZIndex : *TerrainZIndices)
+			OutFoundChunkCells.Emplace(ChunkCell2D.X, ChunkCell2D.Y, ZIndex);
 	}
 }
 
@@ -1479,6 +1920,7 @@ void AChunkManager::SetChunkName(AChunkActor* Chunk, const FIntVector& ChunkRepC
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE(AChunkManager::RenameChunk);
 		Chunk->Rename(*NewName, this, REN_ForceNoResetLoaders);
+		Chunk->bHasReplicatedName = true;
 	}
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE(AChunkManager::AddNewNameToUsedNames);
@@ -1486,14 +1928,13 @@ void AChunkManager::SetChunkName(AChunkActor* Chunk, const FIntVector& ChunkRepC
 	}
 }
 
-void AChunkManager::DestroyChunksAtHeightmapLocation(const FVector2D& HeightmapLocation, const TArray<int32> ChunkZIndices)
+void AChunkManager::DestroyChunksAtHeightmapCell(const FIntPoint& HeightmapCell, const TArray<int32> ChunkZIndices)
 {
-	TRACE_CPUPROFILER_EVENT_SCOPE(AChunkManager::DestroyChunksAtHeightmapLocation);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AChunkManager::DestroyChunksAtHeightmapCell);
 
-	FIntPoint ChunkCell2D = Get2DCellFromChunkLocation2D(HeightmapLocation, ChunkSize);
 	for (int32 ZIndex : ChunkZIndices)
 	{
-		FIntVector ChunkCell = GetCellFromChunkLocation(FVector(HeightmapLocation.X, HeightmapLocation.Y, ZIndex * ChunkSize), ChunkSize);
+		FIntVector ChunkCell{ HeightmapCell.X, HeightmapCell.Y, ZIndex };
 		AChunkActor* Chunk = ChunksByCell.FindRef(ChunkCell);
 
 		bool bWasHidden{};
@@ -1535,7 +1976,8 @@ void AChunkManager::DestroyOrHideChunk(AChunkActor* Chunk, bool &OutbWasHidden)
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE(AChunkManager::DestroyChunkOnServer);
 
-		Chunk->TearOff();
+		if (Chunk->GetIsReplicated()) // Chunks that never replicated don't need tearing off, which also lets them go back into the pool
+			Chunk->TearOff();
 		ChunksToDestroyQueue.Add(ChunkCell);
 	}
 	else if (GetNetMode() == ENetMode::NM_Client || GetNetMode() == ENetMode::NM_Standalone)
@@ -1629,29 +2071,28 @@ bool AChunkManager::UnhideChunk(FIntVector ChunkCell)
 }
 
 // Only call from game thread
-void AChunkManager::UnhideChunksInHeightmapLocations(TArray<FVector2D>* HeightmapLocations)
+void AChunkManager::UnhideChunksInHeightmapCells(TArray<FIntPoint>* HeightmapCells)
 {
-	TRACE_CPUPROFILER_EVENT_SCOPE(AChunkManager::UnhideChunksInHeightmapLocations);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AChunkManager::UnhideChunksInHeightmapCells);
 	
-	if (!HeightmapLocations || (GetNetMode() != NM_Client))
+	if (!HeightmapCells || (GetNetMode() != NM_Client))
 		return;
 
 	if (!IsInGameThread())
 	{
-		AsyncTask(ENamedThreads::GameThread, [this, HeightmapLocations]()
-			{ UnhideChunksInHeightmapLocations(HeightmapLocations); });
+		AsyncTask(ENamedThreads::GameThread, [this, HeightmapCells]()
+			{ UnhideChunksInHeightmapCells(HeightmapCells); });
 		return;
 	}
-	for (FVector2D& HeightmapLocation : *HeightmapLocations)
+	for (const FIntPoint& ChunkCell2D : *HeightmapCells)
 	{
-		FIntPoint ChunkCell2D = Get2DCellFromChunkLocation2D(HeightmapLocation, ChunkSize);
 		TArray<int32>* ChunkZIndicesPtr = ChunkZIndicesBy2DCell.Find(ChunkCell2D);
 		if (!ChunkZIndicesPtr)
 			continue;
 
 		for (const int32& ZIndex : *ChunkZIndicesPtr)
 		{
-			FIntVector ChunkCell = GetCellFromChunkLocation(FVector(HeightmapLocation.X, HeightmapLocation.Y, ZIndex * ChunkSize), ChunkSize);
+			FIntVector ChunkCell{ ChunkCell2D.X, ChunkCell2D.Y, ZIndex };
 			if (!UnhideChunk(ChunkCell))
 				return; // If we didn't need to unhide one, the rest are already unhidden
 		}
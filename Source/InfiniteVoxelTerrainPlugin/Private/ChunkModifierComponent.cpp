@@ -193,15 +193,8 @@ void UChunkModifierComponent::ServerSetVoxel_Implementation(FVector DesiredVoxel
 		if (!VoxelGameMode)
 			return;
 
-		TArray<APlayerController*> PlayerControllers{ ChunkManager->TrackedPlayers };
 		TArray<UChunkModifierComponent*> ChunkModifierComponents;
-		for (APlayerController* PlayerController : PlayerControllers)
-		{
-			UChunkModifierComponent* Component{ PlayerController->FindComponentByClass<UChunkModifierComponent>() };
-			if (Component && Component != CallingComponent)
-				ChunkModifierComponents.Add(Component);
-		}
-		ChunkModifierComponents.Remove(this);
+		GetOtherChunkModifierComponents(CallingComponent, ChunkModifierComponents);
 		for (UChunkModifierComponent* ChunkModifier : ChunkModifierComponents)
 			ChunkModifier->ClientSetVoxel(DesiredVoxelLocation, VoxelValue, ChunkManager->GetCellFromChunkLocation(DesiredVoxelLocation, ChunkManager->ChunkSize));
 	}
@@ -213,6 +206,18 @@ void UChunkModifierComponent::ServerSetVoxel_Implementation(FVector DesiredVoxel
 	}
 }
 
+void UChunkModifierComponent::GetOtherChunkModifierComponents(UChunkModifierComponent* CallingComponent, TArray<UChunkModifierComponent*>& OutChunkModifierComponents)
+{
+	TArray<APlayerController*> PlayerControllers{ ChunkManager->TrackedPlayers };
+	for (APlayerController* PlayerController : PlayerControllers)
+	{
+		UChunkModifierComponent* Component{ PlayerController->FindComponentByClass<UChunkModifierComponent>() };
+		if (Component && Component != CallingComponent)
+			OutChunkModifierComponents.Add(Component);
+	}
+	OutChunkModifierComponents.Remove(this);
+}
+
 void UChunkModifierComponent::ClientSetVoxel_Implementation(FVector VoxelLocation, int32 VoxelValue, FIntVector ChunkCell)
 {
 	if (GetNetMode() != NM_Client)
@@ -234,6 +239,53 @@ void UChunkModifierComponent::FailedSetVoxel_Implementation(FVector VoxelLocatio
 	ChunkManager->SetVoxel(VoxelLocation, PreviousVoxelValue, ChunkCell, bSetVoxelInAdjacentChunk);
 }
 
+void UChunkModifierComponent::SetVoxelsInShape(const FVoxelShapeEdit& ShapeEdit)
+{
+	if (!ChunkManager)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("SetVoxelsInShape failed because ChunkManager was nullptr"));
+		return;
+	}
+
+	// Snapped and rounded the same way the RPC quantizes them, so this machine applies exactly the edit every other machine receives
+	auto RoundVector = [](const FVector& Vector) { return FVector(FMath::RoundToFloat(Vector.X), FMath::RoundToFloat(Vector.Y), FMath::RoundToFloat(Vector.Z)); };
+	FVoxelShapeEdit SnappedShapeEdit{ ShapeEdit };
+	SnappedShapeEdit.Center = RoundVector(FVector(ShapeEdit.Center).GridSnap(ChunkManager->VoxelSize));
+	SnappedShapeEdit.End = RoundVector(FVector(ShapeEdit.End).GridSnap(ChunkManager->VoxelSize));
+	SnappedShapeEdit.Extent = RoundVector(ShapeEdit.Extent);
+
+	// Unlike AttemptSetVoxel, shape edits don't check for overlapping pawns, so the server never has to revert one
+	if (GetNetMode() == NM_Client || GetNetMode() == NM_Standalone)
+		ChunkManager->SetVoxelsInShape(SnappedShapeEdit);
+
+	if (GetNetMode() != NM_Standalone)
+		ServerSetVoxelsInShape(SnappedShapeEdit, this);
+}
+
+// Runs on server. Called by client or server
+void UChunkModifierComponent::ServerSetVoxelsInShape_Implementation(const FVoxelShapeEdit& ShapeEdit, UChunkModifierComponent* CallingComponent)
+{
+	if (!ChunkManager)
+		return;
+
+	ChunkManager->SetVoxelsInShape(ShapeEdit);
+
+	TArray<UChunkModifierComponent*> ChunkModifierComponents;
+	GetOtherChunkModifierComponents(CallingComponent, ChunkModifierComponents);
+	for (UChunkModifierComponent* ChunkModifier : ChunkModifierComponents)
+		ChunkModifier->ClientSetVoxelsInShape(ShapeEdit);
+}
+
+void UChunkModifierComponent::ClientSetVoxelsInShape_Implementation(const FVoxelShapeEdit& ShapeEdit)
+{
+	if (GetNetMode() != NM_Client)
+		return;
+
+	if (!ChunkManager)
+		return;
+	ChunkManager->SetVoxelsInShape(ShapeEdit);
+}
+
 void UChunkModifierComponent::ClientReceiveRegionData_Implementation(FRegionData RegionData, bool bIsLastBundle)
 {
 	if (!ChunkManager)
@@ -7,9 +7,12 @@
 #include "Math/IntVector.h"
 #include "DrawDebugHelpers.h"
 
-FCriticalSection FChunkThread::ChunkZMutex;
-TMap<FIntPoint, TArray<int32>> FChunkThread::ChunkZIndicesBy2DCell{};
-TMap<FIntPoint, TArray<int32>> FChunkThread::ModifiedAdditionalChunkZIndicesBy2DCell{};
+TShardedCellMap<TArray<int32>> FChunkThread::ChunkZIndicesBy2DCell{};
+TShardedCellMap<TArray<int32>> FChunkThread::ModifiedAdditionalChunkZIndicesBy2DCell{};
+FCriticalSection FChunkThread::SpiralOffsetsMutex;
+TMap<int32, TSharedPtr<const TArray<FIntPoint>>> FChunkThread::SpiralOffsetsByRadius{};
+FCriticalSection FChunkThread::HeightmapCacheMutex;
+TLruCache<FIntPoint, FCachedHeightmap> FChunkThread::HeightmapCache{};
 
 bool FChunkThread::Init()
 {
@@ -17,6 +20,13 @@ bool FChunkThread::Init()
 	return true;
 }
 
+FChunkThread::~FChunkThread()
+{
+	if (WorkEvent)
+		FPlatformProcess::ReturnSynchEventToPool(WorkEvent);
+	WorkEvent = nullptr;
+}
+
 uint32 FChunkThread::Run()
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::Run);
@@ -24,6 +34,18 @@ uint32 FChunkThread::Run()
 	InitializeNoiseGenerators();
 	if (!WorldRef) return 1;
 
+	if (ThreadIndex == 0 && WorldRef->GetNetMode() != NM_Client && !WorldSaveName.IsEmpty()) // Only the first thread loads and saves regions
+	{
+		ChunkManagerRef->RegionSaveScheduler.Start([this](const FIntPoint& Region, bool bRemoveDataWhenDone)
+			{
+				return SaveVoxelsForRegion(WorldSaveName, Region, bRemoveDataWhenDone);
+			});
+		RecoverEditJournal();
+		ChunkManagerRef->EditJournal.Open(GetSaveFolderPath(WorldSaveName));
+	}
+
+	ChunkManagerRef->ChunkJobQueue.AddWorkerEvent(WorkEvent);
+
 	while (bIsRunning) // Generate chunks until we are told to stop
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::RunLoop);
@@ -31,50 +53,50 @@ uint32 FChunkThread::Run()
 		UpdateTrackingVariables();
 		UpdateTempVariables();
 
-		if (PlayerLocations.IsEmpty() || !PlayerLocations.IsValidIndex(TrackedIndex))
+		if (PlayerCells.IsEmpty())
 		{
 			if(WorldRef->GetNetMode() != NM_DedicatedServer)
 				UE_LOG(LogTemp, Warning, TEXT("Thread %i has no tracked locations!"), ThreadIndex);
-			FPlatformProcess::Sleep(ThreadIdleSleepTime);
+			WorkEvent->Wait(); // The ChunkManager wakes us when the tracked locations change
 			continue;
 		}
 
-		if (!bIsRunning || !WorldRef) return 0;
+		if (!bIsRunning || !WorldRef) break;
 
 		UpdateChunks();
-
-		if (bIsFirstTime)
-			LastHeightmapLocation = PlayerLocations[TrackedIndex];
-
-		if (!PrepareRegionForGeneration())
+		UpdatePendingRegions();
+		if (ThreadIndex == 0 && (bDidTrackedActorMove || bWasRangeChanged || bIsFirstTime))
 		{
-			FPlatformProcess::Sleep(ThreadIdleSleepTime);
-			continue;
+			bIsFirstTime = false;
+			bWasRangeChanged = false;
+			EnqueueNeededHeightmaps();
 		}
 
-		FVector2D HeightmapLocation{};
-		TArray<FVector2D>* CheckLocationsNeedingUnhide{}; // If we are the client, we need to check if we need to unhide chunks that were hidden
-		bool bWasHeightmapNeeded{ FindNextNeededHeightmap(HeightmapLocation, CheckLocationsNeedingUnhide) };
-		ChunkManagerRef->UnhideChunksInHeightmapLocations(CheckLocationsNeedingUnhide);
-		LastHeightmapLocation = HeightmapLocation;
-
-		if (!bWasHeightmapNeeded)
+		FIntPoint HeightmapCell{};
+		if (!FindNextNeededHeightmap(HeightmapCell))
 		{
-			FPlatformProcess::Sleep(ThreadIdleSleepTime);
+			WorkEvent->Wait(); // Sleep until jobs are added, region data is ready, or the tracked locations change
 			continue;
 		}
 
+		const double WorkStartTime{ FPlatformTime::Seconds() };
+
 		TArray<TSharedPtr<FChunkConstructionData>> ChunkConstructionDataArray{};
 		TArray<int32> TerrainZIndices{};
-		
-		if (!GenerateChunkData(HeightmapLocation, TerrainZIndices, ChunkConstructionDataArray))
+		FChunkJobTokenPtr JobToken{ ChunkManagerRef->ChunkJobQueue.StartJob(HeightmapCell) };
+		if (!IsClaimedHeightmapCellKept(HeightmapCell))
+		{
+			ReleaseCancelledJob(HeightmapCell);
 			continue;
-		
-		AsyncSpawnChunks(ChunkConstructionDataArray, HeightmapLocation, TerrainZIndices);
+		}
 
-		FPlatformProcess::Sleep(ThreadWorkingSleepTime);
+		if (GenerateChunkData(HeightmapCell, TerrainZIndices, ChunkConstructionDataArray, JobToken))
+			QueueChunksForSpawn(ChunkConstructionDataArray);
+
+		ThrottleToCPUBudget(FPlatformTime::Seconds() - WorkStartTime);
 	}
 
+	ChunkManagerRef->ChunkJobQueue.RemoveWorkerEvent(WorkEvent);
 	return 0;
 }
 
@@ -83,14 +105,20 @@ void FChunkThread::Stop()
 	if (ThreadIndex > 0)
 	{
 		bIsRunning = false;
+		WorkEvent->Trigger();
 
 		return; // Only the first thread should save the world
 	}
 
 	if (WorldRef->GetNetMode() == ENetMode::NM_DedicatedServer || WorldRef->GetNetMode() == ENetMode::NM_ListenServer || WorldRef->GetNetMode() == ENetMode::NM_Standalone)
+	{
 		SaveUnsavedRegions(false);
+		ChunkManagerRef->RegionSaveScheduler.Stop();
+		ChunkManagerRef->EditJournal.Close();
+	}
 
 	bIsRunning = false;
+	WorkEvent->Trigger();
 }
 
 void FChunkThread::InitializeNoiseGenerators()
@@ -109,14 +137,19 @@ bool FChunkThread::UpdateTrackingVariables()
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::UpdateTrackingVariables);
 
-	TArray<FVector2D> NewTrackedLocations{  };
+	TArray<FIntPoint> NewTrackedCells{};
+	TArray<FVector2D> NewViewDirections{};
+	TArray<FIntPoint> NewPredictedCells{};
 
 	{
 		FReadScopeLock Lock(ChunkManagerRef->ThreadPlayerLocationsLock);
-		NewTrackedLocations = ChunkManagerRef->ThreadUseableLocations;
+		NewTrackedCells = ChunkManagerRef->ThreadUseablePlayerCells;
+		NewPredictedCells = ChunkManagerRef->ThreadUseablePredictedCells;
+		NewViewDirections = ChunkManagerRef->ThreadUseableViewDirections;
+		PlayerVelocities = ChunkManagerRef->ThreadUseableVelocities;
 	}
 
-	if (NewTrackedLocations.IsEmpty() || !bIsRunning)
+	if (NewTrackedCells.IsEmpty() || !bIsRunning)
 	{
 		if (WorldRef->GetNetMode() != NM_DedicatedServer)
 			UE_LOG(LogTemp, Warning, TEXT("No tracked locations found!"));
@@ -125,49 +158,16 @@ bool FChunkThread::UpdateTrackingVariables()
 		return bDidTrackedActorMove;
 	}
 
-	for (FVector2D& TrackedLocation : NewTrackedLocations)
-		TrackedLocation = GetLocationSnappedToChunkGrid2D(TrackedLocation, ChunkSize);
-
-	if (PlayerLocations.Num() > 0)
-		TrackedIndex = (TrackedIndex + 1) % PlayerLocations.Num();
-
 	// If nothing has changed we don't need to continue
-	if (NewTrackedLocations == PlayerLocations)
+	if (NewTrackedCells == PlayerCells && NewViewDirections == PlayerViewDirections && NewPredictedCells == PredictedPlayerCells)
 	{
 		bDidTrackedActorMove = false;
 		return bDidTrackedActorMove;
 	}
 
-	for (int32 PlayerIndex{}; PlayerIndex < NewTrackedLocations.Num(); PlayerIndex++)
-	{
-		if (!TrackedChunkRingCount.IsValidIndex(PlayerIndex))
-		{
-			TrackedChunkRingCount.Add(0);
-			TrackedChunkRingDistance.Add(0);
-		}
-	}
-
-	for (int32 TrackedActorIndex{}; TrackedActorIndex < PlayerLocations.Num(); TrackedActorIndex++)
-	{
-		if (!TrackedChunkRingCount.IsValidIndex(TrackedActorIndex))
-		{
-			TrackedChunkRingCount.Add(0);
-			TrackedChunkRingDistance.Add(0);
-		}
-
-		if (!NewTrackedLocations.IsValidIndex(TrackedActorIndex) || !PlayerLocations.IsValidIndex(TrackedActorIndex) || !TrackedChunkRingCount.IsValidIndex(TrackedActorIndex) || !TrackedChunkRingDistance.IsValidIndex(TrackedActorIndex))
-			continue;
-
-		FVector2D CurrentActorLocation = NewTrackedLocations[TrackedActorIndex];
-		FVector2D OldActorLocation = PlayerLocations[TrackedActorIndex];
-		int32 ChunksMoved = FMath::Max(FMath::CeilToInt32(FVector2D::Distance(CurrentActorLocation, OldActorLocation)) / ChunkSize, 2) + 1;
-		TrackedChunkRingCount[TrackedActorIndex] = FMath::Max(TrackedChunkRingCount[TrackedActorIndex] - ChunksMoved, 0);
-		TrackedChunkRingDistance[TrackedActorIndex] = FMath::Max(TrackedChunkRingDistance[TrackedActorIndex] - ChunksMoved, 0);
-
-		ChunkAngleIndex = 0;
-	}
-
-	PlayerLocations = NewTrackedLocations;
+	PlayerCells = NewTrackedCells;
+	PredictedPlayerCells = NewPredictedCells;
+	PlayerViewDirections = NewViewDirections;
 
 	bDidTrackedActorMove = true;
 	return bDidTrackedActorMove;
@@ -178,19 +178,11 @@ void FChunkThread::UpdateTempVariables()
 	if (bWasRangeChanged)
 		bDidTrackedActorMove = true;
 
-	{
-		// These values might be changed by the game thread while we loop, so we copy them to local variables
-		FScopeLock Lock(&ChunkGenMutex);
-
-		TempGenrationRadius = ChunkGenerationRadius;
-		TempCollisionGenRadius = CollisionGenerationRadius;
-		TempChunkGenRadius = ChunkGenerationRadius;
-	}
+	// These values might be changed by the game thread while we loop, so we copy them to local variables
+	FScopeLock Lock(&ChunkGenMutex);
 
-	if (GetGenDistanceShouldBeCollision(TrackedIndex))
-		TempGenrationRadius = TempCollisionGenRadius;
-	else
-		TempGenrationRadius = TempChunkGenRadius;
+	TempCollisionGenRadius = CollisionGenerationRadius;
+	TempChunkGenRadius = ChunkGenerationRadius;
 }
 
 void FChunkThread::UpdateChunks()
@@ -208,62 +200,101 @@ void FChunkThread::UpdateChunks()
 	TUniquePtr<TArray<FIntVector>> CellsToUnhidePtr{ MakeUnique<TArray<FIntVector>>() };
 	TUniquePtr<TArray<FIntVector>> CellsToHidePtr{ MakeUnique<TArray<FIntVector>>() };
 
-	TArray TempPlayerLocations{ PlayerLocations };
-	{
-		FScopeLock HeightmapLock(&ChunkManagerRef->HeightmapMutex);
-		FScopeLock ChunkZLock(&ChunkZMutex);
-		bool bIsDedicatedServer{ WorldRef->GetNetMode() == ENetMode::NM_DedicatedServer };
-		bool bIsListenServer{ WorldRef->GetNetMode() == ENetMode::NM_ListenServer };
-		for (const FVector2D& ExistingHeightmapLocation : ChunkManagerRef->ExistingHeightmapLocations)
+	TArray TempPlayerCells{ PlayerCells };
+	TArray TempPredictedCells{ PredictedPlayerCells };
+
+	// Columns still being generated for cells we are about to unload are dropped at their next stage
+	ChunkManagerRef->ChunkJobQueue.CancelJobs([&](const FIntPoint& HeightmapCell)
 		{
-			FIntPoint ChunkCell2D{ AChunkManager::Get2DCellFromChunkLocation2D(ExistingHeightmapLocation, ChunkSize) };
-			TArray<int32>* ChunkZIndices{ ChunkZIndicesBy2DCell.Find(ChunkCell2D) };
-			if (!ChunkZIndices)
-				continue;
+			return !IsHeightmapCellKept(HeightmapCell, TempPlayerCells, TempPredictedCells);
+		});
 
-			bool bIsNeeded{ IsNeededHeightmapLocation(ExistingHeightmapLocation, TempPlayerLocations, TempChunkGenRadius + ChunkDeletionBuffer, TempCollisionGenRadius) };
-			if (!bIsNeeded) // If we don't need the chunk at all, no other checks are performed
+	bool bIsListenServer{ WorldRef->GetNetMode() == ENetMode::NM_ListenServer };
+	const int32 ServerRadius{ TempChunkGenRadius + ChunkDeletionBuffer };
+
+	// Only the cells that were in range last time but aren't now can be unloaded, so we work out that ring from the old and new cells instead of checking every existing heightmap
+	// If the players or radii changed in a way the old cells can't describe, we fall back to checking every existing heightmap
+	TSet<FIntPoint> CellsToRemove2D{};
+	TSet<FIntPoint> CellsToHide2D{};
+	TSet<FIntPoint> CellsToUnhide2D{};
+	const bool bCanUseRingDeltas{ LastKeptChunkGenRadius == TempChunkGenRadius && LastKeptCollisionGenRadius == TempCollisionGenRadius
+		&& LastKeptPlayerCells.Num() == TempPlayerCells.Num() && LastKeptPredictedCells.Num() == TempPredictedCells.Num() };
+	if (bCanUseRingDeltas)
+	{
+		TSet<FIntPoint> CellsLeavingRange{};
+		for (int32 PlayerIndex{}; PlayerIndex < TempPlayerCells.Num(); PlayerIndex++)
+			AddCellsLeavingRange(CellsLeavingRange, LastKeptPlayerCells[PlayerIndex], TempPlayerCells[PlayerIndex], GetKeepRadius(PlayerIndex));
+		for (int32 PlayerIndex{}; PlayerIndex < TempPredictedCells.Num(); PlayerIndex++)
+			AddCellsLeavingRange(CellsLeavingRange, LastKeptPredictedCells[PlayerIndex], TempPredictedCells[PlayerIndex], GetPredictionGenRadius(PlayerIndex) + ChunkDeletionBuffer);
+
+		for (const FIntPoint& LeavingCell : CellsLeavingRange) // Another player might still need it
+			if (!IsHeightmapCellKept(LeavingCell, TempPlayerCells, TempPredictedCells))
+				CellsToRemove2D.Add(LeavingCell);
+
+		if (bIsListenServer && !TempPlayerCells.IsEmpty()) // Only the listen server does chunk hiding here, for the cells that crossed its own range
+		{
+			TSet<FIntPoint> CellsLeavingServer{};
+			AddCellsLeavingRange(CellsLeavingServer, LastKeptPlayerCells[0], TempPlayerCells[0], ServerRadius);
+			for (const FIntPoint& LeavingCell : CellsLeavingServer)
+				if (!CellsToRemove2D.Contains(LeavingCell))
+					CellsToHide2D.Add(LeavingCell);
+			AddCellsLeavingRange(CellsToUnhide2D, TempPlayerCells[0], LastKeptPlayerCells[0], ServerRadius); // Entering the server's range is leaving it in reverse
+		}
+	}
+	else
+	{
+		TArray<FIntPoint> ExistingHeightmapCells{};
+		ChunkManagerRef->ExistingHeightmapCells.GetCells(ExistingHeightmapCells);
+		for (const FIntPoint& ExistingHeightmapCell : ExistingHeightmapCells)
+		{
+			if (!IsHeightmapCellKept(ExistingHeightmapCell, TempPlayerCells, TempPredictedCells)) // If we don't need the chunk at all, no other checks are performed
 			{
-				for (int32& ChunkZ : *ChunkZIndices)
-				{
-					FIntVector ChunkCell{ ChunkCell2D.X, ChunkCell2D.Y, ChunkZ };
-					CellsToRemovePtr->Add(ChunkCell);
-				}
+				CellsToRemove2D.Add(ExistingHeightmapCell);
 				continue;
 			}
 
 			if (!bIsListenServer) // Only the listen server does chunk hiding here
 				continue;
 
-			bool bServerNeedsChunk{ bServerNeedsChunk = IsHeightmapInRange(ExistingHeightmapLocation, TempPlayerLocations[0], TempChunkGenRadius + ChunkDeletionBuffer) };
-			if (bServerNeedsChunk)
-			{
-				for (int32& ChunkZ : *ChunkZIndices)
-				{
-					FIntVector ChunkCell{ ChunkCell2D.X, ChunkCell2D.Y, ChunkZ };
-					CellsToUnhidePtr->Add(ChunkCell);
-				}
-			}
+			if (IsHeightmapInRange(ExistingHeightmapCell, TempPlayerCells[0], ServerRadius))
+				CellsToUnhide2D.Add(ExistingHeightmapCell);
 			else // Listen Server does not need to see the chunk
-			{
-				for (int32& ChunkZ : *ChunkZIndices)
-				{
-					FIntVector ChunkCell{ ChunkCell2D.X, ChunkCell2D.Y, ChunkZ };
-					CellsToHidePtr->Add(ChunkCell);
-				}
-			}
-			ChunkZIndices = nullptr;
+				CellsToHide2D.Add(ExistingHeightmapCell);
 		}
+	}
 
-		for (const FIntVector& CellToRemove : *CellsToRemovePtr)
-		{
-			FIntPoint ChunkCell2D{ CellToRemove.X, CellToRemove.Y };
-			FVector2D HeightmapLocation{ AChunkManager::GetLocationFromChunkCell(CellToRemove, ChunkSize) };
-			ChunkManagerRef->ExistingHeightmapLocations.Remove(HeightmapLocation);
-			ChunkZIndicesBy2DCell.Remove(ChunkCell2D);
-		}
+	LastKeptPlayerCells = TempPlayerCells;
+	LastKeptPredictedCells = TempPredictedCells;
+	LastKeptChunkGenRadius = TempChunkGenRadius;
+	LastKeptCollisionGenRadius = TempCollisionGenRadius;
+
+	// Each lookup and removal only locks the shard its cell is in, so the other ChunkThreads aren't stalled by the range checks above
+	for (const FIntPoint& ChunkCell2D : CellsToRemove2D)
+	{
+		TArray<int32> ChunkZIndices{};
+		if (!ChunkZIndicesBy2DCell.RemoveAndCopyValue(ChunkCell2D, ChunkZIndices))
+			continue;
+
+		ChunkManagerRef->ExistingHeightmapCells.Remove(ChunkCell2D); // Removed after the Z indices, so a thread that claims the cell again can't have its new indices removed
+		for (int32 ChunkZ : ChunkZIndices)
+			CellsToRemovePtr->Emplace(ChunkCell2D.X, ChunkCell2D.Y, ChunkZ);
 	}
 
+	auto AddColumnCells = [&](const TSet<FIntPoint>& Cells2D, TArray<FIntVector>& OutCells)
+		{
+			for (const FIntPoint& ChunkCell2D : Cells2D)
+			{
+				TArray<int32> ChunkZIndices{};
+				if (!ChunkZIndicesBy2DCell.Find(ChunkCell2D, ChunkZIndices))
+					continue;
+
+				for (int32 ChunkZ : ChunkZIndices)
+					OutCells.Emplace(ChunkCell2D.X, ChunkCell2D.Y, ChunkZ);
+			}
+		};
+	AddColumnCells(CellsToUnhide2D, *CellsToUnhidePtr);
+	AddColumnCells(CellsToHide2D, *CellsToHidePtr);
+
 	AsyncTask(ENamedThreads::GameThread, [ChunkManager = ChunkManagerRef, CellsToRemovePtr = MoveTemp(CellsToRemovePtr), CellsToUnreplicatePtr = MoveTemp(CellsToUnreplicatePtr), CellsToUnhidePtr = MoveTemp(CellsToUnhidePtr), CellsToHidePtr = MoveTemp(CellsToHidePtr)]() mutable
 		{
 			TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::UpdateChunks::GameThread);
@@ -294,348 +325,504 @@ void FChunkThread::UpdateChunks()
 		});
 }
 
-bool FChunkThread::IsNeededHeightmapLocation(FVector2D ChunkLocation2D, const TArray<FVector2D>& TrackedLocationsRef, int32 ChunkGenRadius, int32 CollisionGenRadius)
+bool FChunkThread::IsNeededHeightmapCell(const FIntPoint& HeightmapCell, const TArray<FIntPoint>& TrackedCells, int32 ChunkGenRadius, int32 CollisionGenRadius)
 {
-	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::IsNeededHeightmapLocation);
+	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::IsNeededHeightmapCell);
 
-	for (int32 LocationIndex{}; LocationIndex < TrackedLocationsRef.Num(); LocationIndex++)
+	for (int32 CellIndex{}; CellIndex < TrackedCells.Num(); CellIndex++)
 	{
-		FVector2D TrackedLocation{ TrackedLocationsRef[LocationIndex] };
-		int32 GenRadius{ (GetGenDistanceShouldBeCollision(LocationIndex) ? CollisionGenRadius + ChunkDeletionBuffer : ChunkGenRadius) };
-		if (IsHeightmapInRange(ChunkLocation2D, TrackedLocation, GenRadius))
+		int32 GenRadius{ (GetGenDistanceShouldBeCollision(CellIndex) ? CollisionGenRadius + ChunkDeletionBuffer : ChunkGenRadius) };
+		if (IsHeightmapInRange(HeightmapCell, TrackedCells[CellIndex], GenRadius))
 			return true;
 	}
 
 	return false;
 }
 
-bool FChunkThread::PrepareRegionForGeneration()
+bool FChunkThread::IsHeightmapCellKept(const FIntPoint& HeightmapCell, const TArray<FIntPoint>& TrackedCells, const TArray<FIntPoint>& PredictedCells)
 {
-	FIntPoint Region{ GetRegionByLocation(FVector2D(LastHeightmapLocation)) };
-	bool bIsReadyForGeneration{ false };
+	if (IsNeededHeightmapCell(HeightmapCell, TrackedCells, TempChunkGenRadius + ChunkDeletionBuffer, TempCollisionGenRadius))
+		return true;
 
-	bool bShouldCheckForRegionData{ (bDidTrackedActorMove || bWasRangeChanged || bIsFirstTime) && ThreadIndex == 0 };
-	if (bShouldCheckForRegionData)
+	// Keep the heightmaps we prefetched ahead of a moving player. The predicted cells match the tracked ones by index
+	for (int32 CellIndex{}; CellIndex < PredictedCells.Num(); CellIndex++)
+		if (IsHeightmapInRange(HeightmapCell, PredictedCells[CellIndex], GetPredictionGenRadius(CellIndex) + ChunkDeletionBuffer))
+			return true;
+
+	return false;
+}
+
+bool FChunkThread::IsClaimedHeightmapCellKept(const FIntPoint& HeightmapCell)
+{
+	// We may have waited on the region long enough for UpdateChunks to unload this cell before our job could be cancelled, and it never checks that cell again
+	// Reading the published cells after StartJob means either we see the cells it unloaded for, or it sees our job and cancels it
+	TArray<FIntPoint> LatestPlayerCells{};
+	TArray<FIntPoint> LatestPredictedCells{};
+	{
+		FReadScopeLock Lock(ChunkManagerRef->ThreadPlayerLocationsLock);
+		LatestPlayerCells = ChunkManagerRef->ThreadUseablePlayerCells;
+		LatestPredictedCells = ChunkManagerRef->ThreadUseablePredictedCells;
+	}
+
+	return LatestPlayerCells.IsEmpty() || IsHeightmapCellKept(HeightmapCell, LatestPlayerCells, LatestPredictedCells);
+}
+
+void FChunkThread::AddCellsLeavingRange(TSet<FIntPoint>& OutCells, const FIntPoint& OldCell, const FIntPoint& NewCell, const int32 RadiusInChunks)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::AddCellsLeavingRange);
+
+	if (OldCell == NewCell)
+		return;
+
+	TSharedPtr<const TArray<FIntPoint>> SpiralOffsets{ GetSpiralOffsets(RadiusInChunks) };
+	for (const FIntPoint& Offset : *SpiralOffsets)
 	{
-		bIsFirstTime = false;
-		bWasRangeChanged = false;
+		FIntPoint HeightmapCell{ OldCell + Offset };
+		if (!IsHeightmapInRange(HeightmapCell, NewCell, RadiusInChunks))
+			OutCells.Add(HeightmapCell);
+	}
+}
 
-		TArray<FIntPoint> RegionsToLoad{};
-		TArray<FIntPoint> RegionsToSave{};
-		GetRegionsToLoad(RegionsToLoad);
-		GetRegionsToSave(RegionsToSave);
-		if (WorldRef->GetNetMode() != NM_Client) // We don't need to load voxels on the client, we will get them from the server
+void FChunkThread::UpdatePendingRegions()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::UpdatePendingRegions);
+
+	if (ThreadIndex != 0)
+		return;
+
+	TArray<FIntPoint> RegionsToLoad{};
+	TArray<FIntPoint> RegionsToSave{};
+	GetRegionsToLoad(RegionsToLoad);
+	GetRegionsToSave(RegionsToSave);
+	if (WorldRef->GetNetMode() != NM_Client) // We don't need to load voxels on the client, we will get them from the server
+	{
+		for (FIntPoint RegionToLoad : RegionsToLoad)
 		{
-			for (FIntPoint RegionToLoad : RegionsToLoad)
-			{
-				LoadVoxelsForRegion(RegionToLoad, WorldSaveName);
+			if (TryLoadRegion(RegionToLoad)) // If another thread is loading it, HandleClientNeededServerData sends it once it's loaded
 				ChunkManagerRef->SendNeededRegionDataOnGameThread(RegionToLoad);
-			}
 		}
+	}
 
-		bool bRemoveVoxelWhenSaved{ true };
-		for (FIntPoint RegionToSave : RegionsToSave)
+	bool bRemoveVoxelWhenSaved{ true };
+	for (FIntPoint RegionToSave : RegionsToSave)
+	{
+		if (WorldRef->GetNetMode() != NM_Client) // When regions are getting saved this way, it's because they are no longer relevant, so we can remove the ModifiedVoxels stored in memory
+			ChunkManagerRef->RegionSaveScheduler.RequestSave(RegionToSave, bRemoveVoxelWhenSaved);
+		else // If we are on the client, we don't save data, but we use the RegionsPendingSave tracking system to know which regions we are safe to remove from memory. They will be sent again when needed
 		{
-			if (WorldRef->GetNetMode() != NM_Client) // When regions are getting saved this way, it's because they are no longer relevant, so we can remove the ModifiedVoxels stored in memory
-				AsyncSaveVoxelsForRegion(RegionToSave, WorldSaveName, bRemoveVoxelWhenSaved);
-			else // If we are on the client, we don't save data, but we use the RegionsPendingSave tracking system to know which regions we are safe to remove from memory. They will be sent again when needed
 			{
-				{
-					FScopeLock Lock(&ChunkManagerRef->ModifiedVoxelsMutex);
-					ChunkManagerRef->ModifiedVoxelsByCellByRegion.Remove(Region);
-				}
-				FScopeLock Lock(&ChunkManagerRef->RegionMutex);
-				ChunkManagerRef->RegionsPendingSave.Remove(Region);
+				FScopeLock Lock(&ChunkManagerRef->ModifiedVoxelsMutex);
+				ChunkManagerRef->ModifiedVoxelsByCellByRegion.Remove(RegionToSave);
 			}
+			FScopeLock Lock(&ChunkManagerRef->RegionMutex);
+			ChunkManagerRef->RegionsPendingSave.Remove(RegionToSave);
 		}
 	}
+}
 
-	if (WorldRef->GetNetMode() != NM_Client)
-	{
-		FScopeLock Lock(&ChunkManagerRef->RegionMutex);
-		if (!ChunkManagerRef->RegionsAlreadyLoaded.Contains(Region) && ChunkManagerRef->RegionsPendingLoad.Contains(Region))
+void FChunkThread::EnqueueNeededHeightmaps()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::EnqueueNeededHeightmaps);
+
+	// Find every heightmap location in range of a tracked location, prioritized by the best priority from any tracked location
+	TMap<FIntPoint, float> PriorityByHeightmapCell{};
+	auto AddHeightmapsAroundCell = [&](const FIntPoint& CenterCell, const int32 PlayerIndex, const int32 GenRadius)
 		{
-			Lock.Unlock();
+			const FVector2D ViewDirection{ PlayerViewDirections.IsValidIndex(PlayerIndex) ? PlayerViewDirections[PlayerIndex] : FVector2D::ZeroVector };
+			const FVector2D Velocity{ PlayerVelocities.IsValidIndex(PlayerIndex) ? PlayerVelocities[PlayerIndex] : FVector2D::ZeroVector };
+			TSharedPtr<const TArray<FIntPoint>> SpiralOffsets{ GetSpiralOffsets(GenRadius) };
+			for (const FIntPoint& Offset : *SpiralOffsets)
+			{
+				FIntPoint HeightmapCell{ CenterCell + Offset };
+				float Priority{ GetHeightmapPriority(Offset, ViewDirection, Velocity) };
+				float* ExistingPriority{ PriorityByHeightmapCell.Find(HeightmapCell) };
+				if (!ExistingPriority)
+					PriorityByHeightmapCell.Add(HeightmapCell, Priority);
+				else
+					*ExistingPriority = FMath::Min(*ExistingPriority, Priority);
+			}
+		};
 
-			if (!bIsRunning || !WorldRef)
-				return false;
+	for (int32 PlayerIndex{}; PlayerIndex < PlayerCells.Num(); PlayerIndex++)
+		AddHeightmapsAroundCell(PlayerCells[PlayerIndex], PlayerIndex, GetGenRadius(PlayerIndex));
 
-			if (WorldRef->GetNetMode() != NM_Client && ThreadIndex == 0)
-				LoadVoxelsForRegion(Region, WorldSaveName);
+	// The prediction is capped at the generation radius, so the path to it is already covered and only a small area around where the player is heading needs adding
+	// Priority there is measured from the predicted location, so the columns a fast player is heading into come before the ones they are leaving behind
+	for (int32 PlayerIndex{}; PlayerIndex < PredictedPlayerCells.Num(); PlayerIndex++)
+		if (PlayerCells.IsValidIndex(PlayerIndex) && PredictedPlayerCells[PlayerIndex] != PlayerCells[PlayerIndex])
+			AddHeightmapsAroundCell(PredictedPlayerCells[PlayerIndex], PlayerIndex, GetPredictionGenRadius(PlayerIndex));
 
-			return false;
-		}
-		else if (!ChunkManagerRef->RegionsAlreadyLoaded.Contains(Region) && !ChunkManagerRef->RegionsPendingLoad.Contains(Region))
+	TArray<FChunkJob> NeededJobs{};
+	NeededJobs.Reserve(PriorityByHeightmapCell.Num());
+	TArray<FIntPoint>* CellsNeedingUnhide{}; // If we are the client, we need to check if we need to unhide chunks that were hidden
+	for (const TPair<FIntPoint, float>& HeightmapPriorityPair : PriorityByHeightmapCell)
+	{
+		if (!ChunkManagerRef->ExistingHeightmapCells.Contains(HeightmapPriorityPair.Key))
+			NeededJobs.Emplace(HeightmapPriorityPair.Key, HeightmapPriorityPair.Value);
+		else if (WorldRef->GetNetMode() == NM_Client) // Cell did have a chunk
 		{
-			ChunkManagerRef->RegionsPendingLoad.Add(Region);
-			return false;
+			if (!CellsNeedingUnhide)
+				CellsNeedingUnhide = new TArray<FIntPoint>();
+			CellsNeedingUnhide->Add(HeightmapPriorityPair.Key);
 		}
 	}
-	else // Client
+
+	ChunkManagerRef->UnhideChunksInHeightmapCells(CellsNeedingUnhide);
+	ChunkManagerRef->ChunkJobQueue.ReplaceJobs(NeededJobs);
+}
+
+float FChunkThread::GetHeightmapPriority(const FIntPoint& Offset, const FVector2D& ViewDirection, const FVector2D& Velocity) const
+{
+	const float DistanceInChunks{ FMath::Sqrt(static_cast<float>(Offset.SizeSquared())) };
+	if (DistanceInChunks <= 1.f) // The player's own column and its neighbors always come first
+		return DistanceInChunks;
+
+	const FVector2D OffsetDirection{ FVector2D(Offset) / DistanceInChunks };
+	float Priority{ DistanceInChunks };
+
+	// Scales from 1 straight ahead to 1 + ViewPriorityWeight straight behind
+	if (!ViewDirection.IsNearlyZero())
+		Priority *= 1.f + ChunkManagerRef->ViewPriorityWeight * (1.f - FVector2D::DotProduct(OffsetDirection, ViewDirection)) * 0.5f;
+
+	// Moving at a chunk per second or faster gives the full bonus to the heightmaps ahead of the player
+	if (!Velocity.IsNearlyZero())
 	{
-		if (!ChunkManagerRef)
-			return false;
-		// If this region is not tracked as having data
-		bool bDoesClientHaveRegionData{};
+		const float SpeedFactor{ FMath::Min(static_cast<float>(Velocity.Size()) / ChunkSize, 1.f) };
+		const float MovementAlignment{ FMath::Max(static_cast<float>(FVector2D::DotProduct(OffsetDirection, Velocity.GetSafeNormal())), 0.f) };
+		Priority /= 1.f + ChunkManagerRef->VelocityPriorityWeight * SpeedFactor * MovementAlignment;
+	}
+
+	return Priority;
+}
+
+bool FChunkThread::PrepareRegionForGeneration(const FIntPoint& HeightmapCell)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::PrepareRegionForGeneration);
+
+	if (!ChunkManagerRef)
+		return false;
+
+	FIntPoint Region{ GetRegionByCell(HeightmapCell) };
+	if (WorldRef->GetNetMode() == NM_Client) // The client gets region data from the server. AddToRegionsThatHaveData releases our job once it arrives
+	{
+		FScopeLock Lock(&ChunkManagerRef->RegionMutex);
+		return ChunkManagerRef->GetDoesClientHaveRegionData(nullptr, Region);
+	}
+
+	return TryLoadRegion(Region);
+}
+
+bool FChunkThread::TryLoadRegion(const FIntPoint& Region)
+{
+	{
+		FScopeLock Lock(&ChunkManagerRef->RegionMutex);
+		if (ChunkManagerRef->RegionsAlreadyLoaded.Contains(Region))
+			return true;
+		if (ChunkManagerRef->RegionsBeingLoaded.Contains(Region))
+			return false; // The thread loading it will release our job when it's done
+		ChunkManagerRef->RegionsBeingLoaded.Add(Region);
+	}
+
+	ChunkManagerRef->RegionSaveScheduler.WaitForRegion(Region); // A region that was just unloaded may still be saving, and its file is about to be replaced
+
+	{
+		FScopeLock LoadLock(&ChunkManagerRef->RegionLoadMutex);
+		bool bRegionWasLoaded{};
 		{
 			FScopeLock Lock(&ChunkManagerRef->RegionMutex);
-			bDoesClientHaveRegionData = ChunkManagerRef->GetDoesClientHaveRegionData(nullptr, Region);
+			bRegionWasLoaded = ChunkManagerRef->RegionsAlreadyLoaded.Contains(Region); // The save we waited for may have loaded it
 		}
 
-		if (!bDoesClientHaveRegionData)
-		{
-			FPlatformProcess::Sleep(ThreadIdleSleepTime);
-			return false;
-		}
+		if (!bRegionWasLoaded)
+			LoadVoxelsForRegion(Region, WorldSaveName);
 	}
 
+	{
+		FScopeLock Lock(&ChunkManagerRef->RegionMutex);
+		ChunkManagerRef->RegionsBeingLoaded.Remove(Region);
+	}
+	ChunkManagerRef->ChunkJobQueue.ReleaseDeferredJobs();
+
 	return true;
 }
 
-bool FChunkThread::FindNextNeededHeightmap(FVector2D& OutHeightmapLocation, TArray<FVector2D>*& OutLocationsNeedingUnhide)
+bool FChunkThread::FindNextNeededHeightmap(FIntPoint& OutHeightmapCell)
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::FindNextNeededHeightmap);
-	const FVector2D& TrackedLocation{ PlayerLocations[TrackedIndex] };
-	int32& RingChunkDistance{ TrackedChunkRingDistance[TrackedIndex] };
-	int32& RingCount{ TrackedChunkRingCount[TrackedIndex] };
-	const int32& ChunkGenRadius{ TempGenrationRadius };
-	const int32& CollisionGenRadius{ TempCollisionGenRadius };
 
-	OutLocationsNeedingUnhide = nullptr;
-	if (!WorldRef)
+	if (!WorldRef || !ChunkManagerRef)
 	{
 		UE_LOG(LogTemp, Error, TEXT("WorldRef was nullptr!"));
 		return false;
 	}
 
-	bool bFoundNeededHeightmap{ false };
-	while (RingChunkDistance <= ChunkGenRadius && bIsRunning) // Loop until we find a needed heightmap or we reach the edge of the generation radius
+	FChunkJobQueue& JobQueue{ ChunkManagerRef->ChunkJobQueue };
+	FChunkJob Job{};
+	while (bIsRunning && JobQueue.Dequeue(Job))
 	{
-		if (LastRingCount != RingCount) // If the radius has changed
+		uint32 ReleaseCount{ JobQueue.GetReleaseCount() };
+		if (!PrepareRegionForGeneration(Job.HeightmapCell))
 		{
-			CircumferenceInChunks = FMath::Max(CalculateCircumferenceInChunks(RingCount, ChunkSize), 1);
-			ChunkAngleIndex = 0;
+			JobQueue.Defer(Job, ReleaseCount);
+			continue;
 		}
-		LastRingCount = RingCount;
 
-		while (ChunkAngleIndex < CircumferenceInChunks && bIsRunning)
-		{
-			float ChunkYawAngle = (360.f / CircumferenceInChunks) * ChunkAngleIndex;
-			FVector2D HeightmapLocation = FVector2D(GetLocationSnappedToChunkGrid2D(TrackedLocation + FVector2D(FRotator(0, ChunkYawAngle, 0).Vector()) * (FVector2D(ChunkSize) * RingCount / 2.0), ChunkSize));
+		if (!ChunkManagerRef->ExistingHeightmapCells.TryAdd(Job.HeightmapCell))
+			continue; // Another thread or an on-demand spawn got here first
 
-			if (ChunkAngleIndex == 0)
-				RingChunkDistance = FMath::RoundToInt32(FMath::Abs(FVector2D::Distance(HeightmapLocation, TrackedLocation)) / ChunkSize);
+		OutHeightmapCell = Job.HeightmapCell;
+		return true;
+	}
 
-			bool bHeightmapNeedsCollision{ DoesLocationNeedCollision(HeightmapLocation, PlayerLocations, CollisionGenRadius) };
-			{
-				FScopeLock Lock(&ChunkManagerRef->HeightmapMutex);
-				if (ChunkManagerRef && !ChunkManagerRef->ExistingHeightmapLocations.Contains(HeightmapLocation))
-				{
-					ChunkManagerRef->ExistingHeightmapLocations.Emplace(HeightmapLocation);
-					OutHeightmapLocation = HeightmapLocation;
-					ChunkAngleIndex++;
-					bFoundNeededHeightmap = true;
+	return false;
+}
 
-					return bFoundNeededHeightmap;
-				}
-				else if (WorldRef->GetNetMode() == NM_Client || WorldRef->GetNetMode() == NM_ListenServer) // Location did have a chunk
-				{
-					if (OutLocationsNeedingUnhide)
-						OutLocationsNeedingUnhide->Add(HeightmapLocation);
-					else
-					{
-						OutLocationsNeedingUnhide = new TArray<FVector2D>();
-						OutLocationsNeedingUnhide->Add(HeightmapLocation);
-					}
-				}
-			}
-			ChunkAngleIndex++;
-		}
+void FChunkThread::ThrottleToCPUBudget(const double WorkTime)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::ThrottleToCPUBudget);
 
-		if (ChunkAngleIndex == CircumferenceInChunks)
-			RingCount++;
-	}
+	if (ThreadCPUBudget <= 0.0f || ThreadCPUBudget >= 1.0f)
+		return;
 
-	return bFoundNeededHeightmap;
+	// Rest in proportion to the work we just did, so over time we only use ThreadCPUBudget of a core
+	FPlatformProcess::Sleep(WorkTime * ((1.0f - ThreadCPUBudget) / ThreadCPUBudget));
 }
 
-int32 FChunkThread::CalculateCircumferenceInChunks(const int32 RadiusInChunks, float ChunkSize)
+TSharedPtr<const TArray<FIntPoint>> FChunkThread::GetSpiralOffsets(const int32 RadiusInChunks)
 {
-	// Calculate the circumference of the circle in units
-	float CircumferenceInUnits{ 2.0f * PI * (RadiusInChunks * ChunkSize) };
-	// Convert the circumference to chunks based on the chunk scale along the X and Y axes
-	int32 TempCircumferenceInChunks{ FMath::CeilToInt32(CircumferenceInUnits / ChunkSize) };
+	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::GetSpiralOffsets);
+
+	FScopeLock Lock(&SpiralOffsetsMutex);
+	if (const TSharedPtr<const TArray<FIntPoint>>* CachedOffsets{ SpiralOffsetsByRadius.Find(RadiusInChunks) })
+		return *CachedOffsets;
+
+	TSharedPtr<TArray<FIntPoint>> Offsets{ MakeShared<TArray<FIntPoint>>() };
+	const int32 Radius{ FMath::Max(RadiusInChunks, 0) };
+	for (int32 X{ -Radius }; X <= Radius; X++)
+		for (int32 Y{ -Radius }; Y <= Radius; Y++)
+			if (X * X + Y * Y <= Radius * Radius) // Matches IsHeightmapInRange
+				Offsets->Emplace(X, Y);
+
+	// Sort by distance, then by angle so each ring is walked in the same order every time
+	Offsets->Sort([](const FIntPoint& A, const FIntPoint& B)
+		{
+			const int32 DistanceA{ A.SizeSquared() };
+			const int32 DistanceB{ B.SizeSquared() };
+			if (DistanceA != DistanceB)
+				return DistanceA < DistanceB;
+			return FMath::Atan2(static_cast<float>(A.Y), static_cast<float>(A.X)) < FMath::Atan2(static_cast<float>(B.Y), static_cast<float>(B.X));
+		});
 
-	return TempCircumferenceInChunks;
+	SpiralOffsetsByRadius.Add(RadiusInChunks, Offsets);
+	return Offsets;
 }
 
-bool FChunkThread::GenerateChunkData(FVector2D& HeightmapLocation, TArray<int32>& TerrainZIndices, TArray<TSharedPtr<FChunkConstructionData>>& ChunkConstructionDataArray)
+bool FChunkThread::GenerateChunkData(const FIntPoint& HeightmapCell, TArray<int32>& TerrainZIndices, TArray<TSharedPtr<FChunkConstructionData>>& ChunkConstructionDataArray, const FChunkJobTokenPtr& JobToken)
 {
+	auto IsJobCancelled = [this, &JobToken, &HeightmapCell]()
+		{
+			if (!JobToken.IsValid() || !JobToken->bIsCancelled)
+				return false;
+
+			ReleaseCancelledJob(HeightmapCell);
+			return true;
+		};
+
 	TArray<int16> Heightmap{};
-	GenerateHeightmap(Heightmap, HeightmapLocation, TerrainZIndices);
-	CombineChunkZIndices(HeightmapLocation, TerrainZIndices);
+	GetHeightmap(Heightmap, HeightmapCell, TerrainZIndices);
+	if (IsJobCancelled())
+		return false;
+	CombineChunkZIndices(HeightmapCell, TerrainZIndices);
 
-	if (!AddConstructionData(ChunkConstructionDataArray, HeightmapLocation, TerrainZIndices))
+	if (!AddConstructionData(ChunkConstructionDataArray, HeightmapCell, TerrainZIndices))
 		return false;
+	for (TSharedPtr<FChunkConstructionData>& ConstructionData : ChunkConstructionDataArray)
+		ConstructionData->JobToken = JobToken;
 	
 	GenerateVoxelsForChunks(ChunkConstructionDataArray, Heightmap);
+	if (IsJobCancelled())
+		return false;
 	GenerateMeshDataForChunks(ChunkConstructionDataArray);
-	// If none of the tracked actors have collision for this chunk, it shouldn't be modifiable, so we are probably safe to compress it. You may want to modify this if this assumption doesn't work with your code
-	if (!DoesLocationNeedCollision(HeightmapLocation, PlayerLocations, TempCollisionGenRadius))
-		CompressVoxelData(ChunkConstructionDataArray); // Compress the voxel data if it is not close enough for collision, as we can't modify chunks without collision anyway (Assuming we are using line traces)
+	if (IsJobCancelled())
+		return false;
+	PackVoxelData(ChunkConstructionDataArray);
 
 	return true;
 }
 
+void FChunkThread::ReleaseCancelledJob(const FIntPoint& HeightmapCell)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::ReleaseCancelledJob);
+
+	// Same order as UpdateChunks, which may have already removed the column. That's fine
+	ChunkZIndicesBy2DCell.Remove(HeightmapCell);
+	ChunkManagerRef->ExistingHeightmapCells.Remove(HeightmapCell);
+}
+
+void FChunkThread::GetHeightmap(TArray<int16>& OutHeightmap, const FIntPoint& HeightmapCell, TArray<int32>& OutTerrainZIndices)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::GetHeightmap);
+
+	{
+		FScopeLock Lock(&HeightmapCacheMutex);
+		if (const FCachedHeightmap* CachedHeightmap{ HeightmapCache.FindAndTouch(HeightmapCell) })
+		{
+			OutHeightmap = CachedHeightmap->Heightmap;
+			OutTerrainZIndices = CachedHeightmap->TerrainZIndices;
+			return;
+		}
+	}
+
+	// Generated outside the lock so other ChunkThreads aren't held up by the noise. If two threads miss on the same cell they both generate it, which is harmless
+	OutTerrainZIndices.Empty();
+	GenerateHeightmap(OutHeightmap, AChunkManager::Get2DLocationFromChunkCell2D(HeightmapCell, ChunkSize), OutTerrainZIndices);
+
+	FScopeLock Lock(&HeightmapCacheMutex);
+	if (HeightmapCache.Max() > 0)
+		HeightmapCache.Add(HeightmapCell, FCachedHeightmap{ OutHeightmap, OutTerrainZIndices });
+}
+
+void FChunkThread::ResetHeightmapCache(const int32 MaxCachedHeightmaps)
+{
+	FScopeLock Lock(&HeightmapCacheMutex);
+	HeightmapCache.Empty(FMath::Max(MaxCachedHeightmaps, 0));
+}
+
 void FChunkThread::GenerateHeightmap(TArray<int16>& OutGeneratedHeightmap, const FVector2D& NeededHeightmapLocation, TArray<int32>& OutNeededChunksVerticalIndices)
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::GenerateHeightmap);
 
+	// Ordered to match the biome values in GenerateBlendedHeightmap
+	const TArray<FBiomeNoiseLayer> BiomeLayers{
+		{ nullptr, 0.0f }, // Flat
+		{ ForestNoiseGenerator.get(), 0.4f }, // Forest
+		{ PlainsNoiseGenerator.get(), 0.7f }, // Grassy Plains
+		{ HillsNoiseGenerator.get(), 1.4f }, // Rough Hills
+		{ MountainsNoiseGenerator.get(), 6.3f } }; // Mountains
+
+	GenerateBlendedHeightmap(OutGeneratedHeightmap, NeededHeightmapLocation, OutNeededChunksVerticalIndices, BiomeLayers);
+}
+
+// Can be called from any thread
+void FChunkThread::GenerateBlendedHeightmap(TArray<int16>& OutGeneratedHeightmap, const FVector2D& NeededHeightmapLocation, TArray<int32>& OutNeededChunksVerticalIndices, const TArray<FBiomeNoiseLayer>& BiomeLayers)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::GenerateBlendedHeightmap);
+
 	int32 const HeightmapVoxels1D{ VoxelCount + 2 };
 	int32 const TotalHeightmapVoxels{ HeightmapVoxels1D * HeightmapVoxels1D };
 
 	OutGeneratedHeightmap.Empty();
-	std::vector<float> BiomeHeightmap{};
-	OutGeneratedHeightmap.Reserve(TotalHeightmapVoxels);
-	BiomeHeightmap.reserve(TotalHeightmapVoxels);
+	TArray<float> BiomeHeightmap{};
+	BiomeHeightmap.SetNumUninitialized(TotalHeightmapVoxels);
 	const FVector2D NoiseStartPoint((NeededHeightmapLocation / FVector2D(VoxelSize)) - 1);
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::GenerateHeightmap::FastNoise2NoiseGen);
-		BiomeNoiseGenerator->GenUniformGrid2D(BiomeHeightmap.data(), NoiseStartPoint.X, NoiseStartPoint.Y, HeightmapVoxels1D, HeightmapVoxels1D, TerrainNoiseScale * BiomeNoiseScale, Seed);
+		BiomeNoiseGenerator->GenUniformGrid2D(BiomeHeightmap.GetData(), NoiseStartPoint.X, NoiseStartPoint.Y, HeightmapVoxels1D, HeightmapVoxels1D, TerrainNoiseScale * BiomeNoiseScale, Seed);
 	}
 
-	float HighestVoxel{ FLT_MIN };
-	float LowestVoxel{ FLT_MAX };
-
-	int32 LowerIndex{};
-	int32 UpperIndex{};
-
-	TArray<TPair<int32, float>> BiomeIndexPercentPair;
-	BiomeIndexPercentPair.Reserve(TotalHeightmapVoxels);
-	// === First we calculate which biomes are present at each NoiseIndex ===
+	// === First we calculate which biomes are present at each NoiseIndex, and which positions each biome needs noise for ===
+	// Each position blends at most two biomes. SecondBiomeIndices is INDEX_NONE if the position is 100% one biome
 	const TArray<float> BiomeValues{ -0.666666667, -0.333333333, 0.0, 0.333333333, 0.666666667 };
-	for (int32 NoiseIndex{}; NoiseIndex < TotalHeightmapVoxels; NoiseIndex++)
-	{
-		LowerIndex = 1;
-		UpperIndex = 0;
-
-		const float& BiomeNoisePoint = BiomeHeightmap[NoiseIndex];
-		for (int32 BiomeIndex{}; BiomeIndex < BiomeValues.Num(); ++BiomeIndex)
+	TArray<int32> FirstBiomeIndices{};
+	TArray<int32> SecondBiomeIndices{};
+	TArray<float> FirstBiomePercents{};
+	TArray<float> SecondBiomePercents{};
+	FirstBiomeIndices.SetNumUninitialized(TotalHeightmapVoxels);
+	SecondBiomeIndices.SetNumUninitialized(TotalHeightmapVoxels);
+	FirstBiomePercents.SetNumUninitialized(TotalHeightmapVoxels);
+	SecondBiomePercents.SetNumUninitialized(TotalHeightmapVoxels);
+	TArray<TArray<int32>> PositionsByBiome{};
+	PositionsByBiome.SetNum(BiomeValues.Num());
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::GenerateHeightmap::CalculateBiomePercents);
+		for (int32 NoiseIndex{}; NoiseIndex < TotalHeightmapVoxels; NoiseIndex++)
 		{
-			float BiomeValue = BiomeValues[BiomeIndex];
-			if (BiomeNoisePoint == BiomeValue)
+			int32 LowerIndex{ 1 };
+			int32 UpperIndex{ 0 };
+
+			const float& BiomeNoisePoint = BiomeHeightmap[NoiseIndex];
+			for (int32 BiomeIndex{}; BiomeIndex < BiomeValues.Num(); ++BiomeIndex)
 			{
-				LowerIndex = BiomeIndex;
-				UpperIndex = BiomeIndex;
-				BiomeIndexPercentPair.Add(TPair<int32, float>(BiomeIndex, 1.0f));
-				break; // No need to continue if BiomeNoisePoint matches exactly
+				float BiomeValue = BiomeValues[BiomeIndex];
+				if (BiomeNoisePoint == BiomeValue)
+				{
+					LowerIndex = BiomeIndex;
+					UpperIndex = BiomeIndex;
+					break; // No need to continue if BiomeNoisePoint matches exactly
+				}
+				else if (BiomeNoisePoint > BiomeValue)
+				{
+					LowerIndex = BiomeIndex;
+				}
+				else if (BiomeNoisePoint < BiomeValue)
+				{
+					UpperIndex = BiomeIndex;
+					break; // No need to continue further once UpperIndex is found
+				}
 			}
-			else if (BiomeNoisePoint > BiomeValue)
+
+			FirstBiomeIndices[NoiseIndex] = LowerIndex;
+			PositionsByBiome[LowerIndex].Add(NoiseIndex);
+			if (LowerIndex != UpperIndex)
 			{
-				LowerIndex = BiomeIndex;
+				FirstBiomePercents[NoiseIndex] = (BiomeNoisePoint - BiomeValues[UpperIndex]) / (BiomeValues[LowerIndex] - BiomeValues[UpperIndex]);
+				SecondBiomeIndices[NoiseIndex] = UpperIndex;
+				SecondBiomePercents[NoiseIndex] = 1.0f - FirstBiomePercents[NoiseIndex];
+				PositionsByBiome[UpperIndex].Add(NoiseIndex);
 			}
-			else if (BiomeNoisePoint < BiomeValue)
+			else
 			{
-				UpperIndex = BiomeIndex;
-				break; // No need to continue further once UpperIndex is found
+				FirstBiomePercents[NoiseIndex] = 1.0f;
+				SecondBiomeIndices[NoiseIndex] = INDEX_NONE;
 			}
 		}
-
-		if (LowerIndex != UpperIndex)
-		{
-			float LowerPercentage = (BiomeNoisePoint - BiomeValues[UpperIndex]) / (BiomeValues[LowerIndex] - BiomeValues[UpperIndex]);
-			float UpperPercentage = 1.0f - LowerPercentage;
-
-			BiomeIndexPercentPair.Add(TPair<int32, float>(LowerIndex, LowerPercentage));
-			BiomeIndexPercentPair.Add(TPair<int32, float>(UpperIndex, UpperPercentage));
-		}
 	}
 
-	/// === Next we use that BiomeIndexPercentPair to determine what Noise should be generated for this Point
-	int32 PositionIndex{};
-	FVector2D NoiseLocation{};
-	bool bIsFirstPoint{ true };
-	bool bHasAnotherPoint{ false };
-
-	// BiomeIndexPercentPair Contains either 1 or 2 elements for each noise Point in this chunk
-	for (const TPair<int32, float>& BiomePoint : BiomeIndexPercentPair)
+	// === Next we generate each biome's noise in one batch over only the positions that use that biome ===
+	TArray<TArray<float>> NoiseByBiome{};
+	NoiseByBiome.SetNum(BiomeValues.Num());
+	for (int32 BiomeIndex{}; BiomeIndex < BiomeValues.Num(); BiomeIndex++)
 	{
-		bool bPointBelongsToAdjacentCell{ false };
-
-		if (bIsFirstPoint) // Only calculate the postion once per PositionIndex change
-		{
-			int32 LocationX = PositionIndex % HeightmapVoxels1D;
-			int32 LocationY = PositionIndex / HeightmapVoxels1D;
-			NoiseLocation = (NoiseStartPoint + FVector2D(LocationX, LocationY)) * TerrainNoiseScale;
-
-			// Check if the location is on the border
-			if (LocationX <= 0 || LocationY <= 0 || LocationX >= HeightmapVoxels1D - 1 || LocationY >= HeightmapVoxels1D - 1)
-				bPointBelongsToAdjacentCell = true;
-
-			// If the Point isn't 100% one PositionIndex then we know there is another Point
-			bHasAnotherPoint = (BiomePoint.Value != 1.0);
-		}
-		else
-			bHasAnotherPoint = false;
-
-		float NoisePoint{};
-
 		if (!bIsRunning)
 			return;
 
-		switch (BiomePoint.Key)
-		{
-		default:
-			NoisePoint = PlainsNoiseGenerator->GenSingle2D(NoiseLocation.X, NoiseLocation.Y, Seed);
-			break;
-		case 0: // Flat
-			NoisePoint = 0.0;
-			break;
-		case 1: // Forest
-			NoisePoint = ForestNoiseGenerator->GenSingle2D(NoiseLocation.X, NoiseLocation.Y, Seed) * 0.4;
-			break;
-		case 2: // Grassy Plains
-			NoisePoint = PlainsNoiseGenerator->GenSingle2D(NoiseLocation.X, NoiseLocation.Y, Seed) * 0.7;
-			break;
-		case 3: // Rough Hills
-			NoisePoint = HillsNoiseGenerator->GenSingle2D(NoiseLocation.X, NoiseLocation.Y, Seed) * 1.4;
-			break;
-		case 4: // Mountains
-			NoisePoint = MountainsNoiseGenerator->GenSingle2D(NoiseLocation.X, NoiseLocation.Y, Seed) * 6.3;
-			break;
-		}
+		if (!BiomeLayers.IsValidIndex(BiomeIndex) || !BiomeLayers[BiomeIndex].Generator || PositionsByBiome[BiomeIndex].IsEmpty())
+			continue;
+		GenerateNoiseForPositions(NoiseByBiome[BiomeIndex], BiomeLayers[BiomeIndex].Generator, NoiseStartPoint, PositionsByBiome[BiomeIndex]);
+	}
 
-		// Scale the noise by the percentage of it's biome found at this location
-		NoisePoint *= BiomePoint.Value;
-		int32 VoxelHeight = (NoisePoint * VoxelSize) * TerrainHeightMultiplier;
-		if (bIsFirstPoint)
+	// === Finally we blend the biomes together and find the vertical range of the terrain ===
+	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::GenerateHeightmap::BlendBiomes);
+	auto GetBiomeHeight = [&](const int32 BiomeIndex, const float BiomePercent, const int32 NoiseIndex) -> int32
 		{
-			VoxelHeight -= VoxelCount / 2.0;
-			OutGeneratedHeightmap.Add(VoxelHeight);
-		}
-		else // Add the second Point to the first
-			VoxelHeight = OutGeneratedHeightmap[PositionIndex] += VoxelHeight;
+			if (!BiomeLayers.IsValidIndex(BiomeIndex) || NoiseByBiome[BiomeIndex].IsEmpty())
+				return 0;
+			// Scale the noise by the percentage of it's biome found at this location
+			float NoisePoint{ NoiseByBiome[BiomeIndex][NoiseIndex] * BiomeLayers[BiomeIndex].HeightScale };
+			NoisePoint *= BiomePercent;
+			return (NoisePoint * VoxelSize) * TerrainHeightMultiplier;
+		};
 
-		if (!bHasAnotherPoint)
-		{
-			//if (!bPointBelongsToAdjacentCell)
-			//{
-			VoxelHeight *= VoxelSize;
-			VoxelHeight -= VoxelSize;
-			VoxelHeight -= FMath::GridSnap(ChunkSize / 2, VoxelSize);
-
-			// Calculate the lowest and highest voxels so we know which vertical chunks to spawn
-			if (VoxelHeight > HighestVoxel)
-				HighestVoxel = VoxelHeight;
-			if (VoxelHeight < LowestVoxel)
-				LowestVoxel = VoxelHeight;
-			//}
-
-			PositionIndex++; // Move on to next position
-			bIsFirstPoint = true;
-		}
-		else // Check this Point again
-			bIsFirstPoint = false;
+	float HighestVoxel{ FLT_MIN };
+	float LowestVoxel{ FLT_MAX };
+	OutGeneratedHeightmap.SetNumUninitialized(TotalHeightmapVoxels);
+	for (int32 NoiseIndex{}; NoiseIndex < TotalHeightmapVoxels; NoiseIndex++)
+	{
+		int32 VoxelHeight{ GetBiomeHeight(FirstBiomeIndices[NoiseIndex], FirstBiomePercents[NoiseIndex], NoiseIndex) };
+		VoxelHeight -= VoxelCount / 2.0;
+		OutGeneratedHeightmap[NoiseIndex] = VoxelHeight;
+		if (SecondBiomeIndices[NoiseIndex] != INDEX_NONE) // Add the second biome to the first
+			VoxelHeight = OutGeneratedHeightmap[NoiseIndex] += GetBiomeHeight(SecondBiomeIndices[NoiseIndex], SecondBiomePercents[NoiseIndex], NoiseIndex);
+
+		VoxelHeight *= VoxelSize;
+		VoxelHeight -= VoxelSize;
+		VoxelHeight -= FMath::GridSnap(ChunkSize / 2, VoxelSize);
+
+		// Calculate the lowest and highest voxels so we know which vertical chunks to spawn
+		if (VoxelHeight > HighestVoxel)
+			HighestVoxel = VoxelHeight;
+		if (VoxelHeight < LowestVoxel)
+			LowestVoxel = VoxelHeight;
 	}
 
 	int32 HighestChunkIndex = FMath::GridSnap(HighestVoxel, ChunkSize) / ChunkSize;
@@ -644,40 +831,70 @@ void FChunkThread::GenerateHeightmap(TArray<int16>& OutGeneratedHeightmap, const
 		OutNeededChunksVerticalIndices.Add(ChunkIndex);
 }
 
-void FChunkThread::CombineChunkZIndices(const FVector2D& HeightmapLocation, TArray<int32>& TerrainZIndices)
+// Fills OutNoise so it can be indexed the same as the heightmap. Only the values at PositionIndices are valid
+void FChunkThread::GenerateNoiseForPositions(TArray<float>& OutNoise, const FastNoise::Generator* Generator, const FVector2D& NoiseStartPoint, const TArray<int32>& PositionIndices)
 {
-	FScopeLock Lock(&ChunkZMutex);
-	FIntPoint Cell2D{ AChunkManager::Get2DCellFromChunkLocation2D(HeightmapLocation, ChunkSize) };
-	TArray<int32>& CombinedIndices{ ChunkZIndicesBy2DCell.FindOrAdd(Cell2D) };
-	for (int32 TerrainZIndex : TerrainZIndices)
-		if (!CombinedIndices.Contains(TerrainZIndex))
-			CombinedIndices.Add(TerrainZIndex);
-
-	TArray<int32>* ModifiedChunkAdditionalIndices{ ModifiedAdditionalChunkZIndicesBy2DCell.Find(Cell2D) };
-	if (ModifiedChunkAdditionalIndices) // Add every Z Index we don't already have
-		for (int32 AdditionalIndex : *ModifiedChunkAdditionalIndices)
-			if (!CombinedIndices.Contains(AdditionalIndex))
-				CombinedIndices.Add(AdditionalIndex);
-
-	TerrainZIndices = CombinedIndices;
+	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::GenerateNoiseForPositions);
+
+	int32 const HeightmapVoxels1D{ VoxelCount + 2 };
+	int32 const TotalHeightmapVoxels{ HeightmapVoxels1D * HeightmapVoxels1D };
+	OutNoise.SetNumUninitialized(TotalHeightmapVoxels);
+
+	// A uniform grid is cheaper per point than a position array, so it is worth generating a few unneeded points to use it
+	if (PositionIndices.Num() * 2 > TotalHeightmapVoxels)
+	{
+		Generator->GenUniformGrid2D(OutNoise.GetData(), NoiseStartPoint.X, NoiseStartPoint.Y, HeightmapVoxels1D, HeightmapVoxels1D, TerrainNoiseScale, Seed);
+		return;
+	}
+
+	TArray<float> XPositions{};
+	TArray<float> YPositions{};
+	TArray<float> PositionNoise{};
+	XPositions.SetNumUninitialized(PositionIndices.Num());
+	YPositions.SetNumUninitialized(PositionIndices.Num());
+	PositionNoise.SetNumUninitialized(PositionIndices.Num());
+	for (int32 Index{}; Index < PositionIndices.Num(); Index++)
+	{
+		XPositions[Index] = (NoiseStartPoint.X + (PositionIndices[Index] % HeightmapVoxels1D)) * TerrainNoiseScale;
+		YPositions[Index] = (NoiseStartPoint.Y + (PositionIndices[Index] / HeightmapVoxels1D)) * TerrainNoiseScale;
+	}
+
+	Generator->GenPositionArray2D(PositionNoise.GetData(), PositionIndices.Num(), XPositions.GetData(), YPositions.GetData(), 0.0f, 0.0f, Seed);
+	for (int32 Index{}; Index < PositionIndices.Num(); Index++)
+		OutNoise[PositionIndices[Index]] = PositionNoise[Index];
 }
 
-bool FChunkThread::AddConstructionData(TArray<TSharedPtr<FChunkConstructionData>>& OutChunkConstructionDataArray, const FVector2D& ChunkLocation2D, const TArray<int32>& VerticalChunkIndices)
+void FChunkThread::CombineChunkZIndices(const FIntPoint& HeightmapCell, TArray<int32>& TerrainZIndices)
+{
+	TArray<int32> ModifiedChunkAdditionalIndices{};
+	ModifiedAdditionalChunkZIndicesBy2DCell.Find(HeightmapCell, ModifiedChunkAdditionalIndices);
+
+	ChunkZIndicesBy2DCell.Modify(HeightmapCell, [&](TArray<int32>& CombinedIndices)
+		{
+			for (int32 TerrainZIndex : TerrainZIndices)
+				CombinedIndices.AddUnique(TerrainZIndex);
+
+			for (int32 AdditionalIndex : ModifiedChunkAdditionalIndices) // Add every Z Index we don't already have
+				CombinedIndices.AddUnique(AdditionalIndex);
+
+			TerrainZIndices = CombinedIndices;
+		});
+}
+
+bool FChunkThread::AddConstructionData(TArray<TSharedPtr<FChunkConstructionData>>& OutChunkConstructionDataArray, const FIntPoint& HeightmapCell, const TArray<int32>& VerticalChunkIndices)
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::AddConstructionData);
 
 	int32 LowestIndex{ INT32_MAX };
 	int32 HighestIndex{ INT32_MIN };
 
-	bool bNeedsCollision = DoesLocationNeedCollision(ChunkLocation2D, PlayerLocations, CollisionGenerationRadius);
+	bool bNeedsCollision = DoesCellNeedCollision(HeightmapCell, PlayerCells, CollisionGenerationRadius);
 
 	for (int32 ChunkIndex : VerticalChunkIndices)
 	{
-		float ChunkHeight = ChunkIndex * ChunkSize;
-		FVector ChunkLocation{ ChunkLocation2D.X, ChunkLocation2D.Y, ChunkHeight };
+		FIntVector ChunkCell{ HeightmapCell.X, HeightmapCell.Y, ChunkIndex };
+		FVector ChunkLocation{ AChunkManager::GetLocationFromChunkCell(ChunkCell, ChunkSize) }; // Only the spawned actor needs a world location
 
-		bool bNeedsToUnhideChunk{};
-		FIntVector ChunkCell{ AChunkManager::GetCellFromChunkLocation(ChunkLocation, ChunkSize) };
 		OutChunkConstructionDataArray.Emplace(MakeShared<FChunkConstructionData>(ChunkLocation, ChunkCell, bNeedsCollision));
 	}
 
@@ -690,16 +907,54 @@ void FChunkThread::GenerateVoxelsForChunks(TArray<TSharedPtr<FChunkConstructionD
 
 	TArray<int32> IndicesToRemove;
 
+	// The heightmap is padded the same as the chunks, so its range covers every column they sample
+	const bool bIsHeightmapComplete{ Heightmap.Num() == (VoxelCount + 2) * (VoxelCount + 2) };
+	int32 LowestTerrainHeight{ MAX_int32 };
+	int32 HighestTerrainHeight{ MIN_int32 };
+	for (int16 TerrainHeight : Heightmap)
+	{
+		LowestTerrainHeight = FMath::Min<int32>(LowestTerrainHeight, TerrainHeight);
+		HighestTerrainHeight = FMath::Max<int32>(HighestTerrainHeight, TerrainHeight);
+	}
+
 	for (int32 Index{}; Index < OutChunksConstructionData.Num(); ++Index)
 	{
 		TSharedPtr<FChunkConstructionData>& ConstructionData = OutChunksConstructionData[Index];
 
-		GenerateChunkVoxels(ConstructionData->Voxels, Heightmap, ConstructionData->ChunkLocation);
+		// Chunks with nothing to mesh are skipped entirely unless a player has modified them
+		const bool bIsChunkModified{ ChunkManagerRef->HasModifiedVoxels(ConstructionData->Cell) };
+		uint8 UniformVoxel{};
+		if (bIsHeightmapComplete && GetUniformChunkVoxel(ConstructionData->ChunkLocation, LowestTerrainHeight, HighestTerrainHeight, UniformVoxel))
+		{
+			if (!bIsChunkModified)
+			{
+				IndicesToRemove.Add(Index);
+				continue;
+			}
+			ConstructionData->Voxels.Init(UniformVoxel, TotalChunkVoxels);
+		}
+		else if (!GenerateChunkVoxels(ConstructionData->Voxels, Heightmap, ConstructionData->ChunkLocation) && !bIsChunkModified) // Steep terrain can still leave a chunk all air or buried
+		{
+			IndicesToRemove.Add(Index);
+			continue;
+		}
 
 		// ModifiedVoxelsByCell could exist from changes we made this session, changes from a loaded save, or they could be Received from the server if other players have modified this chunk
 		ApplyModifiedVoxelsToChunk(ConstructionData->Voxels, ConstructionData->Cell);
 	}
 
+	if (IndicesToRemove.IsEmpty())
+		return;
+
+	{
+		// Skipped chunks are taken out of the column so SpawnAdditionalVerticalChunk will still spawn them if an edit reaches them
+		for (int32 Index : IndicesToRemove)
+		{
+			const FIntVector& SkippedCell{ OutChunksConstructionData[Index]->Cell };
+			ChunkZIndicesBy2DCell.ModifyIfFound(FIntPoint(SkippedCell.X, SkippedCell.Y), [&SkippedCell](TArray<int32>& ChunkZIndices) { ChunkZIndices.Remove(SkippedCell.Z); });
+		}
+	}
+
 	// Remove elements in reverse order to avoid shifting indices
 	for (int32 Index = IndicesToRemove.Num() - 1; Index >= 0; --Index)
 		OutChunksConstructionData.RemoveAt(IndicesToRemove[Index]);
@@ -711,8 +966,8 @@ bool FChunkThread::GenerateChunkVoxels(TArray<uint8>& Voxels, const TArray<int16
 
 	Voxels.Empty(TotalChunkVoxels);
 
-	bool bIsBuried{ false }; // Used to determine if the ChunkMesh would be empty
-	bool bIsAllAir{ false }; // Used to determine if the ChunkMesh would be empty
+	bool bIsBuried{ true }; // Used to determine if the ChunkMesh would be empty
+	bool bIsAllAir{ true }; // Used to determine if the ChunkMesh would be empty
 
 	const uint8 GrassBlockIndex = 1;
 	const uint8 DirtBlockIndex = 2;
@@ -770,73 +1025,195 @@ bool FChunkThread::GenerateChunkVoxels(TArray<uint8>& Voxels, const TArray<int16
 	return true;
 }
 
+// Finds chunks that are entirely one voxel from the terrain's height range, without generating their voxels. Keep this in sync with GenerateChunkVoxels
+bool FChunkThread::GetUniformChunkVoxel(const FVector& ChunkLocation, const int32 LowestTerrainHeight, const int32 HighestTerrainHeight, uint8& OutUniformVoxel)
+{
+	const uint8 StoneBlockIndex = 4;
+	const uint8 DirtDepth = 2;
+
+	const int32 LowestVoxelZ{ FMath::RoundToInt32((ChunkLocation.Z / VoxelSize)) - 1 }; // Includes the padding voxels
+	const int32 HighestVoxelZ{ LowestVoxelZ + VoxelCount + 1 };
+	if (LowestVoxelZ >= HighestTerrainHeight) // Every voxel is above the terrain
+	{
+		OutUniformVoxel = 0;
+		return true;
+	}
+	if (HighestVoxelZ < LowestTerrainHeight - 1 - DirtDepth) // Every voxel is below the dirt
+	{
+		OutUniformVoxel = StoneBlockIndex;
+		return true;
+	}
+
+	return false;
+}
+
 void FChunkThread::ApplyModifiedVoxelsToChunk(TArray<uint8>& Voxels, FIntVector ChunkCell)
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::ApplyModifiedVoxelsToChunk);
 
+	ChunkManagerRef->ReadUnreadChunkRecord(ChunkCell); // Loading a region only reads its index, so this is the first time we need this chunk's saved voxels
+
 	FScopeLock Lock(&ChunkManagerRef->ModifiedVoxelsMutex);
-	FIntPoint Region{ GetRegionByLocation(FVector2D(FVector(ChunkCell) * ChunkSize)) };
-	TMap<FIntVector, TArray<uint8>>* ModifiedVoxelsByCell{ ChunkManagerRef->ModifiedVoxelsByCellByRegion.Find(Region) };
+	FIntPoint Region{ GetRegionByCell(FIntPoint(ChunkCell.X, ChunkCell.Y)) };
+	TMap<FIntVector, FModifiedChunkVoxels>* ModifiedVoxelsByCell{ ChunkManagerRef->ModifiedVoxelsByCellByRegion.Find(Region) };
 
 	if (!ModifiedVoxelsByCell)
 		return;
-	TArray<uint8>* ModifiedVoxels{ ModifiedVoxelsByCell->Find(ChunkCell) };
+	FModifiedChunkVoxels* ModifiedVoxels{ ModifiedVoxelsByCell->Find(ChunkCell) };
 	if (!ModifiedVoxels || ModifiedVoxels->IsEmpty())
 		return;
 
-	if (ModifiedVoxels->Num() > TotalChunkVoxels || ModifiedVoxels->Num() < TotalChunkVoxels)
+	if (ModifiedVoxels->IsDense() && ModifiedVoxels->GetDenseNum() != TotalChunkVoxels)
 	{
-		UE_LOG(LogTemp, Error, TEXT("ModifiedVoxels at %s has an invalid number of elements %i. Should be %i"), *ChunkCell.ToString(), ModifiedVoxels->Num(), TotalChunkVoxels);
+		UE_LOG(LogTemp, Error, TEXT("ModifiedVoxels at %s has an invalid number of elements %i. Should be %i"), *ChunkCell.ToString(), ModifiedVoxels->GetDenseNum(), TotalChunkVoxels);
 		return;
 	}
 
-	for (int32 VoxelIndex{}; VoxelIndex < TotalChunkVoxels; VoxelIndex++) // We loop through and overwrite every voxel that was moddified. UINT8_MAX indicates the voxel has not been modified
+	if (!ModifiedVoxels->ApplyToVoxels(Voxels)) // Set the Chunk's voxels to match the player-modified ones
+		UE_LOG(LogTemp, Warning, TEXT("Failed to apply modified voxels to ChunkCell %s"), *ChunkCell.ToString());
+}
+
+void FChunkThread::GenerateMeshDataForChunks(TArray<TSharedPtr<FChunkConstructionData>>& OutConstructionChunks)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::GenerateMeshDataForChunks);
+
+	for (TSharedPtr<FChunkConstructionData>& NeededChunk : OutConstructionChunks)
 	{
-		if (!ModifiedVoxels->IsValidIndex(VoxelIndex))
-		{
-			UE_LOG(LogTemp, Warning, TEXT("Failed to apply modified voxels to ChunkCell %s"), *ChunkCell.ToString());
-			return;
-		}
-		if (!Voxels.IsValidIndex(VoxelIndex))
+		GenerateChunkMeshData(
+			NeededChunk->SlabMeshData,
+			NeededChunk->Voxels,
+			NeededChunk->Cell,
+			NeededChunk->bShouldGenerateCollision);
+	}
+}
+
+// Can be called from any thread
+void FChunkThread::GenerateChunkMeshData(TArray<FChunkMeshData>& OutSlabMeshData, TArray<uint8>& Voxels, const FIntVector ChunkCell, const bool bShouldGenerateCollisionAtChunkSpawn, const uint32 SlabsToMesh)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FTerrainChunkThread::GenerateChunkMeshData);
+
+	if (Voxels.IsEmpty())
+	{
+		UE_LOG(LogTemp, Error, TEXT("Tried to generate a chunk with no voxels!"));
+		return;
+	}
+
+	// The face masks cover the whole chunk, so we build them once and let each slab pick out its own range of Z
+	TArray<uint64> ExposedFaceMasks{};
+	if (!BuildExposedFaceMasks(Voxels, ExposedFaceMasks))
+		return;
+
+	const int32 SlabCount{ GetChunkSlabCount(VoxelCount) };
+	for (int32 SlabIndex{}; SlabIndex < SlabCount; SlabIndex++)
+	{
+		if (!(SlabsToMesh & (1u << SlabIndex)))
+			continue;
+
+		FChunkMeshData& SlabMeshData{ OutSlabMeshData.Emplace_GetRef(ECR_Block, ChunkCell, bShouldGenerateCollisionAtChunkSpawn) };
+		SlabMeshData.SlabIndex = SlabIndex;
+		if (bUseGreedyMeshing)
+			GenerateGreedySlabMeshData(SlabMeshData, Voxels, ExposedFaceMasks);
+		else
+			GenerateSlabMeshData(SlabMeshData, Voxels, ExposedFaceMasks);
+	}
+}
+
+// Can be called from any thread
+void FChunkThread::GenerateSlabMeshData(FChunkMeshData& OutChunkMeshData, const TArray<uint8>& Voxels, const TArray<uint64>& ExposedFaceMasks)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::GenerateSlabMeshData);
+
+	RealtimeMesh::TRealtimeMeshStreamBuilder<FVector3f> PositionBuilder(OutChunkMeshData.ChunkStreamSet.AddStream(RealtimeMesh::FRealtimeMeshStreams::Position, RealtimeMesh::GetRealtimeMeshBufferLayout<FVector3f>()));
+	RealtimeMesh::TRealtimeMeshStreamBuilder<RealtimeMesh::FRealtimeMeshTangentsHighPrecision, RealtimeMesh::FRealtimeMeshTangentsNormalPrecision> TangentBuilder(
+		OutChunkMeshData.ChunkStreamSet.AddStream(RealtimeMesh::FRealtimeMeshStreams::Tangents, RealtimeMesh::GetRealtimeMeshBufferLayout<RealtimeMesh::FRealtimeMeshTangentsNormalPrecision>()));
+	RealtimeMesh::TRealtimeMeshStreamBuilder<FVector2f, FVector2DHalf> TexCoordsBuilder(OutChunkMeshData.ChunkStreamSet.AddStream(RealtimeMesh::FRealtimeMeshStreams::TexCoords, RealtimeMesh::GetRealtimeMeshBufferLayout<FVector2DHalf>()));
+	RealtimeMesh::TRealtimeMeshStreamBuilder<FColor> ColorBuilder(OutChunkMeshData.ChunkStreamSet.AddStream(RealtimeMesh::FRealtimeMeshStreams::Color, RealtimeMesh::GetRealtimeMeshBufferLayout<FColor>()));
+	RealtimeMesh::TRealtimeMeshStreamBuilder<uint32, uint16> PolygroupsBuilder(OutChunkMeshData.ChunkStreamSet.AddStream(RealtimeMesh::FRealtimeMeshStreams::PolyGroups, RealtimeMesh::GetRealtimeMeshBufferLayout<uint16>()));
+	TArray<TArray<FVector>> TrianglesByVoxelValue{};
+
+	int32 NumberOfTris{};
+	FVector3f ChunkMeshOffset{ -ChunkSize / 2 };
+	TSet<uint8> VoxelValuesInThisChunk{};
+
+	const int32 SlabMinZ{ OutChunkMeshData.SlabIndex * ChunkSlabHeightInVoxels };
+	const int32 SlabHeight{ FMath::Min(ChunkSlabHeightInVoxels, VoxelCount - SlabMinZ) };
+	const uint64 SlabZMask{ ((uint64{ 1 } << SlabHeight) - 1) << SlabMinZ };
+
+	FVector3f VoxelLocation{ ChunkMeshOffset };
+	// Loop through all columns in the chunk except the border voxels technically belonging to adjacent chunks
+	// Only the set bits of each column's face masks are visited, so buried and air voxels cost nothing here
+	for (int32 X{}; X < VoxelCount; X++)
+	{
+		VoxelLocation.X = ChunkMeshOffset.X + (X * VoxelSize);
+		for (int32 Y{}; Y < VoxelCount; Y++)
 		{
-			UE_LOG(LogTemp, Warning, TEXT("Voxels[%i] is an invalid index! Failed to apply modified voxels to ChunkCell %s"), VoxelIndex, *ChunkCell.ToString());
-			return;
+			VoxelLocation.Y = ChunkMeshOffset.Y + (Y * VoxelSize);
+			for (int32 FaceIndex{}; FaceIndex < 6; FaceIndex++)
+			{
+				uint64 FaceMask{ ExposedFaceMasks[GetFaceMaskIndex(FaceIndex, X, Y)] & SlabZMask };
+				if (!FaceMask)
+					continue;
+
+				const FVector Normal{ FaceDirections[FaceIndex] };
+				const FVector3f Tangent{ CalculateTangent(Normal) };
+				while (FaceMask)
+				{
+					const int32 Z{ static_cast<int32>(FMath::CountTrailingZeros64(FaceMask)) };
+					FaceMask &= FaceMask - 1; // Clear the lowest set bit
+					VoxelLocation.Z = ChunkMeshOffset.Z + (Z * VoxelSize);
+
+					int32 VoxelIndex{};
+					GetVoxelIndex(VoxelIndex, X, Y, Z);
+					const uint8& VoxelValue{ Voxels[VoxelIndex] };
+
+					FSetElementId PolyGroupID{ VoxelValuesInThisChunk.FindId(VoxelValue) };
+					if (!PolyGroupID.IsValidId())
+					{
+						PolyGroupID = VoxelValuesInThisChunk.Add(VoxelValue);
+						TrianglesByVoxelValue.Add(TArray<FVector>());
+					}
+
+					int32 Verts[4]{};
+					for (int32 VertIndex{}; VertIndex < 4; VertIndex++)
+					{
+						Verts[VertIndex] = PositionBuilder.Add(VoxelLocation + (CubeVertLocations[FaceIndex][VertIndex] * FVector3f(VoxelSize)));
+						TangentBuilder.Add(RealtimeMesh::FRealtimeMeshTangentsHighPrecision(FVector3f(Normal), Tangent));
+						ColorBuilder.Add(FColor(FaceIndex, 0, 0, 0));
+						TexCoordsBuilder.Add(CalculateUV(FaceIndex, VertIndex));
+					}
+
+					TrianglesByVoxelValue[PolyGroupID.AsInteger()].Add(FVector(Verts[0], Verts[3], Verts[2]));
+					TrianglesByVoxelValue[PolyGroupID.AsInteger()].Add(FVector(Verts[2], Verts[1], Verts[0]));
+					NumberOfTris += 2;
+				}
+			}
 		}
-		if ((*ModifiedVoxels)[VoxelIndex] == UINT8_MAX)
-			continue;
-
-		Voxels[VoxelIndex] = (*ModifiedVoxels)[VoxelIndex]; // Set the Chunk's voxel to match the player-modified one
 	}
-}
-
-void FChunkThread::GenerateMeshDataForChunks(TArray<TSharedPtr<FChunkConstructionData>>& OutConstructionChunks)
-{
-	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::GenerateMeshDataForChunks);
 
-	for (TSharedPtr<FChunkConstructionData>& NeededChunk : OutConstructionChunks)
 	{
-		GenerateChunkMeshData(
-			NeededChunk->MeshData,
-			NeededChunk->Voxels,
-			NeededChunk->Cell,
-			NeededChunk->bShouldGenerateCollision);
+		TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::GenerateSlabMeshData::CombineStreams);
+		RealtimeMesh::TRealtimeMeshStreamBuilder<RealtimeMesh::TIndex3<uint32>, RealtimeMesh::TIndex3<uint16>> TrianglesBuilder(OutChunkMeshData.ChunkStreamSet.AddStream(RealtimeMesh::FRealtimeMeshStreams::Triangles, RealtimeMesh::GetRealtimeMeshBufferLayout<RealtimeMesh::TIndex3<uint16>>()));
+		TrianglesBuilder.Reserve(NumberOfTris);
+		for (int32 GroupIndex{}; GroupIndex < TrianglesByVoxelValue.Num(); GroupIndex++)
+		{
+			int32 TrisInThisSection{ TrianglesByVoxelValue[GroupIndex].Num() };
+			for (int32 TriangleIndex{}; TriangleIndex < TrisInThisSection; TriangleIndex++)
+			{
+				PolygroupsBuilder.Add(GroupIndex);
+				TrianglesBuilder.Add(RealtimeMesh::TIndex3<uint32>(TrianglesByVoxelValue[GroupIndex][TriangleIndex].X, TrianglesByVoxelValue[GroupIndex][TriangleIndex].Y, TrianglesByVoxelValue[GroupIndex][TriangleIndex].Z));
+			}
+		}
+
+		for (uint8 VoxelValue : VoxelValuesInThisChunk)
+			OutChunkMeshData.VoxelSections.Add(VoxelValue);
 	}
+	OutChunkMeshData.bIsMeshEmpty = VoxelValuesInThisChunk.IsEmpty();
 }
 
 // Can be called from any thread
-void FChunkThread::GenerateChunkMeshData(FChunkMeshData& OutChunkMeshData, TArray<uint8>& Voxels, const FIntVector ChunkCell, const bool bShouldGenerateCollisionAtChunkSpawn)
+void FChunkThread::GenerateGreedySlabMeshData(FChunkMeshData& OutChunkMeshData, const TArray<uint8>& Voxels, const TArray<uint64>& ExposedFaceMasks)
 {
-	TRACE_CPUPROFILER_EVENT_SCOPE(FTerrainChunkThread::GenerateChunkMeshData);
-
-	OutChunkMeshData.CollisionType = ECR_Block;
-	OutChunkMeshData.ChunkCell = ChunkCell;
-	OutChunkMeshData.bShouldGenCollision = bShouldGenerateCollisionAtChunkSpawn;
-
-	if (Voxels.IsEmpty())
-	{
-		UE_LOG(LogTemp, Error, TEXT("Tried to generate a chunk with no voxels!"));
-		return;
-	}
+	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::GenerateGreedySlabMeshData);
 
 	RealtimeMesh::TRealtimeMeshStreamBuilder<FVector3f> PositionBuilder(OutChunkMeshData.ChunkStreamSet.AddStream(RealtimeMesh::FRealtimeMeshStreams::Position, RealtimeMesh::GetRealtimeMeshBufferLayout<FVector3f>()));
 	RealtimeMesh::TRealtimeMeshStreamBuilder<RealtimeMesh::FRealtimeMeshTangentsHighPrecision, RealtimeMesh::FRealtimeMeshTangentsNormalPrecision> TangentBuilder(
@@ -850,73 +1227,126 @@ void FChunkThread::GenerateChunkMeshData(FChunkMeshData& OutChunkMeshData, TArra
 	FVector3f ChunkMeshOffset{ -ChunkSize / 2 };
 	TSet<uint8> VoxelValuesInThisChunk{};
 
+	// One slice of exposed faces. Holds the voxel value owning the face, or INDEX_NONE if there is no face
+	TArray<int16> FaceMask{};
+	FaceMask.Init(INDEX_NONE, VoxelCount * VoxelCount);
+
+	// Only this slab's range of Z is meshed, so quads never merge across slabs
+	const int32 SlabMinZ{ OutChunkMeshData.SlabIndex * ChunkSlabHeightInVoxels };
+	const FIntVector RangeMin{ 0, 0, SlabMinZ };
+	const FIntVector RangeMax{ VoxelCount, VoxelCount, FMath::Min(SlabMinZ + ChunkSlabHeightInVoxels, VoxelCount) };
+
 	int32 VoxelIndex{};
-	int32 AdjacentVoxelIndex{};
-	FVector3f VoxelLocation{ ChunkMeshOffset };
-	FIntVector XYZ{};
-	// Loop through all voxels in the chunk except the border voxels technically belonging to adjacent chunks
-	// The chunk is the same size in each direction. This knowledge can help us take some shortcuts
-	for (int32 X{}; X < VoxelCount; X++)
-	{
-		XYZ.X = X;
-		VoxelLocation.X = ChunkMeshOffset.X + (X * VoxelSize);
-		for (int32 Y{}; Y < VoxelCount; Y++)
+	for (int32 FaceIndex{}; FaceIndex < 6; FaceIndex++)
+	{
+		const FIntVector& FaceDirection{ FaceIntDirections[FaceIndex] };
+		// The axis this face points along, and the two axes the face spans
+		const int32 NormalAxis{ FaceDirection.X != 0 ? 0 : (FaceDirection.Y != 0 ? 1 : 2) };
+		const int32 UAxis{ (NormalAxis + 1) % 3 };
+		const int32 VAxis{ (NormalAxis + 2) % 3 };
+		const FVector Normal{ FaceDirections[FaceIndex] };
+		const FVector3f Tangent{ CalculateTangent(Normal) };
+		const int32 MinU{ RangeMin[UAxis] };
+		const int32 MaxU{ RangeMax[UAxis] };
+		const int32 MinV{ RangeMin[VAxis] };
+		const int32 MaxV{ RangeMax[VAxis] };
+
+		for (int32 Slice{ RangeMin[NormalAxis] }; Slice < RangeMax[NormalAxis]; Slice++)
 		{
-			XYZ.Y = Y;
-			VoxelLocation.Y = ChunkMeshOffset.Y + (Y * VoxelSize);
-			for (int32 Z{}; Z < VoxelCount; Z++)
 			{
-				XYZ.Z = Z;
-				GetVoxelIndex(VoxelIndex, X, Y, Z);
-				VoxelLocation.Z = ChunkMeshOffset.Z + (Z * VoxelSize);
-
-				if (!Voxels.IsValidIndex(VoxelIndex))
-					continue;
-				const uint8& VoxelValue{ Voxels[VoxelIndex] };
-				if (VoxelDefinitions[VoxelValue].bIsAir) // Skip the voxel if it is air
-					continue;
-
-				FSetElementId PolyGroupID = VoxelValuesInThisChunk.FindId(VoxelValue);
+				TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::GenerateGreedySlabMeshData::BuildFaceMask);
+				FIntVector XYZ{};
+				XYZ[NormalAxis] = Slice;
+				for (int32 V{ MinV }; V < MaxV; V++)
+				{
+					XYZ[VAxis] = V;
+					for (int32 U{ MinU }; U < MaxU; U++)
+					{
+						XYZ[UAxis] = U;
+						const bool bIsFaceExposed{ ((ExposedFaceMasks[GetFaceMaskIndex(FaceIndex, XYZ.X, XYZ.Y)] >> XYZ.Z) & 1) != 0 };
+						if (bIsFaceExposed)
+							GetVoxelIndex(VoxelIndex, XYZ);
+						FaceMask[V * VoxelCount + U] = bIsFaceExposed ? Voxels[VoxelIndex] : INDEX_NONE;
+					}
+				}
+			}
 
-				for (int32 FaceIndex{}; FaceIndex < 6; FaceIndex++)
+			// Grow each unvisited face along U, then along V while every face in the next row matches, and emit the rectangle as a single quad
+			for (int32 V{ MinV }; V < MaxV; V++)
+			{
+				for (int32 U{ MinU }; U < MaxU;)
 				{
-					GetVoxelIndex(AdjacentVoxelIndex, XYZ + FaceIntDirections[FaceIndex]);
-					if (!(Voxels.IsValidIndex(AdjacentVoxelIndex)))
-						continue;
-					const uint8& AdjacentVoxelValue = Voxels[AdjacentVoxelIndex];
-					if (AdjacentVoxelValue > 0) // If this voxel is solid, we assume this face is buried
+					const int16 MaskValue{ FaceMask[V * VoxelCount + U] };
+					if (MaskValue == INDEX_NONE)
+					{
+						U++;
 						continue;
+					}
+
+					int32 Width{ 1 };
+					while (U + Width < MaxU && FaceMask[V * VoxelCount + U + Width] == MaskValue)
+						Width++;
+
+					int32 Height{ 1 };
+					bool bCanGrow{ true };
+					while (bCanGrow && V + Height < MaxV)
+					{
+						for (int32 WidthIndex{}; WidthIndex < Width; WidthIndex++)
+						{
+							if (FaceMask[(V + Height) * VoxelCount + U + WidthIndex] != MaskValue)
+							{
+								bCanGrow = false;
+								break;
+							}
+						}
+
+						if (bCanGrow)
+							Height++;
+					}
+
+					for (int32 HeightIndex{}; HeightIndex < Height; HeightIndex++)
+						for (int32 WidthIndex{}; WidthIndex < Width; WidthIndex++)
+							FaceMask[(V + HeightIndex) * VoxelCount + U + WidthIndex] = INDEX_NONE;
 
+					const uint8 VoxelValue{ static_cast<uint8>(MaskValue) };
+					FSetElementId PolyGroupID{ VoxelValuesInThisChunk.FindId(VoxelValue) };
 					if (!PolyGroupID.IsValidId())
 					{
-						VoxelValuesInThisChunk.Add(VoxelValue);
-						PolyGroupID = VoxelValuesInThisChunk.FindId(VoxelValue);
+						PolyGroupID = VoxelValuesInThisChunk.Add(VoxelValue);
 						TrianglesByVoxelValue.Add(TArray<FVector>());
 					}
 
-					TArray<int32> Verts{};
-					Verts.Reserve(4);
+					// The quad is centered on the merged voxels, and scaled to cover all of them along U and V
+					FVector3f QuadCenter{};
+					QuadCenter[NormalAxis] = Slice;
+					QuadCenter[UAxis] = U + (Width - 1) / 2.f;
+					QuadCenter[VAxis] = V + (Height - 1) / 2.f;
+					FVector3f QuadSizeInVoxels{ 1.f };
+					QuadSizeInVoxels[UAxis] = Width;
+					QuadSizeInVoxels[VAxis] = Height;
+					const FVector3f QuadLocation{ ChunkMeshOffset + (QuadCenter * VoxelSize) };
+
+					int32 Verts[4]{};
 					for (int32 VertIndex{}; VertIndex < 4; VertIndex++)
 					{
-						FVector3f Tangent{};
-						FVector Normal{ FaceDirections[FaceIndex] };
-						CalculateTangent(Normal);
-						Verts.Add(PositionBuilder.Add(VoxelLocation + (CubeVertLocations[FaceIndex][VertIndex] * FVector3f(VoxelSize))));
+						Verts[VertIndex] = PositionBuilder.Add(QuadLocation + (CubeVertLocations[FaceIndex][VertIndex] * QuadSizeInVoxels * VoxelSize));
 						TangentBuilder.Add(RealtimeMesh::FRealtimeMeshTangentsHighPrecision(FVector3f(Normal), Tangent));
 						ColorBuilder.Add(FColor(FaceIndex, 0, 0, 0));
-						TexCoordsBuilder.Add(CalculateUV(FaceIndex, VertIndex));
+						TexCoordsBuilder.Add(CalculateTiledUV(FaceIndex, VertIndex, QuadSizeInVoxels));
 					}
 
 					TrianglesByVoxelValue[PolyGroupID.AsInteger()].Add(FVector(Verts[0], Verts[3], Verts[2]));
 					TrianglesByVoxelValue[PolyGroupID.AsInteger()].Add(FVector(Verts[2], Verts[1], Verts[0]));
 					NumberOfTris += 2;
+
+					U += Width;
 				}
 			}
 		}
 	}
 
 	{
-		TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::GenerateChunkMeshData::CombineStreams);
+		TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::GenerateGreedySlabMeshData::CombineStreams);
 		RealtimeMesh::TRealtimeMeshStreamBuilder<RealtimeMesh::TIndex3<uint32>, RealtimeMesh::TIndex3<uint16>> TrianglesBuilder(OutChunkMeshData.ChunkStreamSet.AddStream(RealtimeMesh::FRealtimeMeshStreams::Triangles, RealtimeMesh::GetRealtimeMeshBufferLayout<RealtimeMesh::TIndex3<uint16>>()));
 		TrianglesBuilder.Reserve(NumberOfTris);
 		for (int32 GroupIndex{}; GroupIndex < TrianglesByVoxelValue.Num(); GroupIndex++)
@@ -935,6 +1365,80 @@ void FChunkThread::GenerateChunkMeshData(FChunkMeshData& OutChunkMeshData, TArra
 	OutChunkMeshData.bIsMeshEmpty = VoxelValuesInThisChunk.IsEmpty();
 }
 
+// Can be called from any thread
+bool FChunkThread::BuildExposedFaceMasks(const TArray<uint8>& Voxels, TArray<uint64>& OutExposedFaceMasks)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::BuildExposedFaceMasks);
+
+	const int32 PaddedVoxelCount{ VoxelCount + 2 };
+	if (VoxelCount > MaxChunkVoxelCount)
+	{
+		UE_LOG(LogTemp, Error, TEXT("VoxelCount of %i is too large to mesh. The max is %i"), VoxelCount, MaxChunkVoxelCount);
+		return false;
+	}
+	if (Voxels.Num() != TotalChunkVoxels)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Tried to mesh a chunk with %i voxels. Should be %i"), Voxels.Num(), TotalChunkVoxels);
+		return false;
+	}
+
+	// Look up each voxel value once instead of once per face
+	bool bIsSolidByValue[UINT8_MAX + 1]{};
+	bool bIsOccludingByValue[UINT8_MAX + 1]{};
+	for (int32 VoxelValue{}; VoxelValue <= UINT8_MAX; VoxelValue++)
+	{
+		bIsSolidByValue[VoxelValue] = VoxelDefinitions.IsValidIndex(VoxelValue) && !VoxelDefinitions[VoxelValue].bIsAir;
+		bIsOccludingByValue[VoxelValue] = IsVoxelOccluding(VoxelValue);
+	}
+
+	// Z is contiguous in the padded voxel array, so every (X, Y) column packs into a single uint64 with bit Z set per voxel, border voxels included
+	const int32 ColumnCount{ PaddedVoxelCount * PaddedVoxelCount };
+	TArray<uint64> SolidColumns{};
+	TArray<uint64> OccludingColumns{};
+	SolidColumns.SetNumUninitialized(ColumnCount);
+	OccludingColumns.SetNumUninitialized(ColumnCount);
+	const uint8* VoxelData{ Voxels.GetData() };
+	for (int32 ColumnIndex{}; ColumnIndex < ColumnCount; ColumnIndex++)
+	{
+		const uint8* ColumnVoxels{ VoxelData + (ColumnIndex * PaddedVoxelCount) };
+		uint64 SolidColumn{};
+		uint64 OccludingColumn{};
+		for (int32 Z{}; Z < PaddedVoxelCount; Z++)
+		{
+			SolidColumn |= static_cast<uint64>(bIsSolidByValue[ColumnVoxels[Z]]) << Z;
+			OccludingColumn |= static_cast<uint64>(bIsOccludingByValue[ColumnVoxels[Z]]) << Z;
+		}
+		SolidColumns[ColumnIndex] = SolidColumn;
+		OccludingColumns[ColumnIndex] = OccludingColumn;
+	}
+
+	// A face is exposed when its voxel is solid and the neighbour in the face direction does not occlude it
+	// The results are shifted down by one so bit 0 is the first voxel belonging to this chunk
+	const uint64 InnerVoxelsMask{ ((uint64{ 1 } << VoxelCount) - 1) << 1 };
+	OutExposedFaceMasks.SetNumUninitialized(6 * VoxelCount * VoxelCount);
+	for (int32 X{}; X < VoxelCount; X++)
+	{
+		for (int32 Y{}; Y < VoxelCount; Y++)
+		{
+			const int32 ColumnIndex{ (X + 1) * PaddedVoxelCount + (Y + 1) };
+			const uint64 SolidColumn{ SolidColumns[ColumnIndex] & InnerVoxelsMask };
+			OutExposedFaceMasks[GetFaceMaskIndex(0, X, Y)] = (SolidColumn & ~(OccludingColumns[ColumnIndex] >> 1)) >> 1; // Up
+			OutExposedFaceMasks[GetFaceMaskIndex(1, X, Y)] = (SolidColumn & ~(OccludingColumns[ColumnIndex] << 1)) >> 1; // Down
+			OutExposedFaceMasks[GetFaceMaskIndex(2, X, Y)] = (SolidColumn & ~OccludingColumns[ColumnIndex + 1]) >> 1; // Right
+			OutExposedFaceMasks[GetFaceMaskIndex(3, X, Y)] = (SolidColumn & ~OccludingColumns[ColumnIndex - 1]) >> 1; // Left
+			OutExposedFaceMasks[GetFaceMaskIndex(4, X, Y)] = (SolidColumn & ~OccludingColumns[ColumnIndex + PaddedVoxelCount]) >> 1; // Front
+			OutExposedFaceMasks[GetFaceMaskIndex(5, X, Y)] = (SolidColumn & ~OccludingColumns[ColumnIndex - PaddedVoxelCount]) >> 1; // Back
+		}
+	}
+
+	return true;
+}
+
+bool FChunkThread::IsVoxelOccluding(const uint8 VoxelValue) const
+{
+	return VoxelValue > 0; // If this voxel is solid, we assume the face next to it is buried
+}
+
 FVector2f FChunkThread::CalculateUV(const int32& FaceIndex, const int32& VertIndex)
 {
 	FVector2f UV;
@@ -967,58 +1471,52 @@ FVector2f FChunkThread::CalculateUV(const int32& FaceIndex, const int32& VertInd
 	return UV;
 }
 
-bool FChunkThread::DoesLocationNeedCollision(FVector2D ChunkLocation2D, const TArray<FVector2D>& TrackedLocationsRef, int32 ChunkGenRadius)
+FVector2f FChunkThread::CalculateTiledUV(const int32& FaceIndex, const int32& VertIndex, const FVector3f& QuadSizeInVoxels)
 {
-	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::DoesLocationNeedCollision);
+	FVector2f UV{ CalculateUV(FaceIndex, VertIndex) };
 
-	for (int32 LocationIndex{}; LocationIndex < TrackedLocationsRef.Num(); LocationIndex++)
-	{
-		FVector2D TrackedLocation{ TrackedLocationsRef[LocationIndex] };
-		if (IsHeightmapInRange(ChunkLocation2D, TrackedLocation, ChunkGenRadius))
+	// Scale each UV axis by the number of voxels the quad covers along the matching world axis, so the texture repeats once per voxel
+	UV.X *= FaceIndex < 4 ? QuadSizeInVoxels.X : QuadSizeInVoxels.Y;
+	UV.Y *= FaceIndex < 2 ? QuadSizeInVoxels.Y : QuadSizeInVoxels.Z;
+
+	return UV;
+}
+
+bool FChunkThread::DoesCellNeedCollision(const FIntPoint& Cell2D, const TArray<FIntPoint>& TrackedCells, int32 ChunkGenRadius)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::DoesCellNeedCollision);
+
+	for (const FIntPoint& TrackedCell : TrackedCells)
+		if (IsHeightmapInRange(Cell2D, TrackedCell, ChunkGenRadius))
 			return true;
-	}
 
 	return false;
 }
 
-void FChunkThread::CompressVoxelData(TArray<TSharedPtr<FChunkConstructionData>>& ChunkConstructionDataArray)
+void FChunkThread::PackVoxelData(TArray<TSharedPtr<FChunkConstructionData>>& ChunkConstructionDataArray)
 {
-	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::CompressVoxelData);
+	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::PackVoxelData);
 
 	for (TSharedPtr<FChunkConstructionData>& ConstrctionChunk : ChunkConstructionDataArray)
 	{
-		ConstrctionChunk->bAreVoxelsCompressed = true;
-		RunLengthEncode(ConstrctionChunk->Voxels, ConstrctionChunk->Cell);
+		ConstrctionChunk->PackedVoxels.Pack(ConstrctionChunk->Voxels);
+		ConstrctionChunk->Voxels.Empty(); // The unpacked voxels aren't needed once the mesh data is generated
 	}
 }
 
-void FChunkThread::AsyncSpawnChunks(TArray<TSharedPtr<FChunkConstructionData>>& ChunkConstructionDataArray, const FVector2D& HeightmapLocation, const TArray<int32>& TerrainZIndices)
+void FChunkThread::QueueChunksForSpawn(TArray<TSharedPtr<FChunkConstructionData>>& ChunkConstructionDataArray)
 {
-	int32 ChunkCount{};
-	for (TSharedPtr<FChunkConstructionData>& ChunkConstructionData : ChunkConstructionDataArray)
-	{
-		// Throttle this so we don't have a massive number of chunks needed to be generated on the game thread at once (especially useful when we have large stacks of vertical chunks)
-		FPlatformProcess::Sleep(FMath::Min(ThreadWorkingSleepTime * ChunkCount++, 0.05));
-		if (!bIsRunning || !WorldRef) return;
+	if (!bIsRunning || !WorldRef) return;
 
-		int32 TempChunkRadius{ TempChunkGenRadius };
-		int32 TempCollisionRadius{ TempCollisionGenRadius };
-		// This function runs on the GameThread, we can fire and forget it
-		AsyncTask(ENamedThreads::GameThread, [ChunkConstructionData, TerrainZIndices, TempChunkRadius, TempCollisionRadius, this]()
-			{
-				// Pass the moved data to the function
-				SpawnChunkFromConstructionData(ChunkConstructionData, TempChunkRadius, TempCollisionRadius);
-			});
-	}
-	ChunkConstructionDataArray.Empty();
+	ChunkManagerRef->EnqueueChunksToSpawn(ChunkConstructionDataArray);
 }
 
-bool FChunkThread::ShouldSpawnHidden(FVector2D ChunkLocation, int32 ChunkGenRadius)
+bool FChunkThread::ShouldSpawnHidden(const FIntPoint& Cell2D, int32 ChunkGenRadius)
 {
-	return ChunkManagerRef->GetNetMode() == ENetMode::NM_ListenServer && !IsHeightmapInRange(ChunkLocation, PlayerLocations[0], ChunkGenRadius);
+	return ChunkManagerRef->GetNetMode() == ENetMode::NM_ListenServer && !IsHeightmapInRange(Cell2D, PlayerCells[0], ChunkGenRadius);
 }
 
-// This function runs on the game thread. Called by AsyncTaskGraph in ChunkThread's Run()
+// This function runs on the game thread. Called by the ChunkManager as it works through its ChunkSpawnQueue
 void FChunkThread::SpawnChunkFromConstructionData(TSharedPtr<FChunkConstructionData> OutNeededChunk, int32 ChunkGenRadius, int32 CollisionGenRadius, bool bShouldGenerateMesh)
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::SpawnChunkFromConstructionData);
@@ -1044,7 +1542,11 @@ void FChunkThread::SpawnChunkFromConstructionData(TSharedPtr<FChunkConstructionD
 
 	bool bClientHadChunkName{ false };
 	bool bIsNewChunk{ Chunk == nullptr };
+	bool bWasChunkPooled{ false };
 	if (bIsNewChunk)
+		bWasChunkPooled = (Chunk = ChunkManagerRef->TakePooledChunk()) != nullptr;
+
+	if (bIsNewChunk && !bWasChunkPooled)
 	{
 		// Set actor parameters
 		FActorSpawnParameters SpawnParameters;
@@ -1076,8 +1578,9 @@ void FChunkThread::SpawnChunkFromConstructionData(TSharedPtr<FChunkConstructionD
 		Chunk->VoxelCount = VoxelCount;
 		Chunk->VoxelSize = VoxelSize;
 		Chunk->ChunkSize = ChunkSize;
-		Chunk->Voxels = MoveTemp(OutNeededChunk->Voxels);
-		Chunk->bAreVoxelsCompressed = OutNeededChunk->bAreVoxelsCompressed;
+		if (OutNeededChunk->PackedVoxels.IsEmpty()) // Chunks generated outside of a ChunkThread loop haven't been packed yet
+			OutNeededChunk->PackedVoxels.Pack(OutNeededChunk->Voxels);
+		Chunk->Voxels = MoveTemp(OutNeededChunk->PackedVoxels);
 	}
 	if (ChunkManagerRef->GetNetMode() == ENetMode::NM_Client)
 	{
@@ -1100,7 +1603,9 @@ void FChunkThread::SpawnChunkFromConstructionData(TSharedPtr<FChunkConstructionD
 	else
 		Chunk->bIsSafeToDestroy = true;
 
-	if (bIsNewChunk) // Finish spawning the actor
+	if (bWasChunkPooled)
+		Chunk->ActivateFromPool(OutNeededChunk->ChunkLocation);
+	else if (bIsNewChunk) // Finish spawning the actor
 		Chunk->FinishSpawning(FTransform(OutNeededChunk->ChunkLocation));
 
 	if (!Chunk)
@@ -1109,11 +1614,11 @@ void FChunkThread::SpawnChunkFromConstructionData(TSharedPtr<FChunkConstructionD
 		return;
 	}
 
-	if ((ChunkManagerRef->GetNetMode() == ENetMode::NM_DedicatedServer || ChunkManagerRef->GetNetMode() == NM_ListenServer) && IsNeededHeightmapLocation(FVector2D(OutNeededChunk->ChunkLocation), PlayerLocations, CollisionGenRadius, CollisionGenRadius)) // We don't want to modify this data if we are on a client, as the client populates this data from the server
+	if ((ChunkManagerRef->GetNetMode() == ENetMode::NM_DedicatedServer || ChunkManagerRef->GetNetMode() == NM_ListenServer) && IsNeededHeightmapCell(Cell2D, PlayerCells, CollisionGenRadius, CollisionGenRadius)) // We don't want to modify this data if we are on a client, as the client populates this data from the server
 		EnableReplicationForChunk(Chunk);
 
 	// This indicates we generated this chunk for a player other than the host player, so we can hide it
-	if (ShouldSpawnHidden(FVector2D(Chunk->GetActorLocation()), ChunkGenRadius + ChunkDeletionBuffer))
+	if (ShouldSpawnHidden(Cell2D, ChunkGenRadius + ChunkDeletionBuffer))
 		ChunkManagerRef->HideChunk(Chunk);
 
 	if (!ChunkManagerRef->VoxelTypesDatabase)
@@ -1129,60 +1634,126 @@ void FChunkThread::SpawnChunkFromConstructionData(TSharedPtr<FChunkConstructionD
 	if (!bShouldGenerateMesh)
 		return;
 
-	TArray<UMaterial*> VoxelMaterials{};
-	ChunkManagerRef->GetMaterialsForChunkData(OutNeededChunk->MeshData.VoxelSections, VoxelMaterials);
-	Chunk->GenerateChunkMesh(OutNeededChunk->MeshData, VoxelMaterials);
+	ChunkManagerRef->ApplySlabMeshData(Chunk, OutNeededChunk->SlabMeshData);
 }
 
 void FChunkThread::SaveUnsavedRegions(bool bSaveAsync)
 {
-	TArray<FIntPoint> RegionsToSave;
+	if (IsInGameThread() && bSaveAsync) // We only run this async if we aren't closing out the thread. If we are we need to make sure we save the data before we close, so we can't do it Async
+	{
+		AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [this]()
+			{
+				SaveUnsavedRegions(false);
+			});
+
+		return;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::SaveUnsavedRegions);
+
+	FScopeLock SaveLock(&SaveUnsavedRegionsMutex);
+
+	// Edits made from here on go in a fresh journal, and mark their regions changed again for the next save
+	const bool bRotatedJournal{ ChunkManagerRef->EditJournal.Rotate() };
+
+	TArray<FIntPoint> RegionsToSave{};
 	{
 		FScopeLock Lock(&ChunkManagerRef->RegionMutex);
-		RegionsToSave = ChunkManagerRef->RegionsChangedSinceLastSave;
+		RegionsToSave = MoveTemp(ChunkManagerRef->RegionsChangedSinceLastSave);
+		ChunkManagerRef->RegionsChangedSinceLastSave.Reset();
 	}
-	for (FIntPoint Region : RegionsToSave) // We only run this async if we aren't closing out the thread. If we are we need to make sure we save the data before we close, so we can't do it Async
-		AsyncSaveVoxelsForRegion(Region, WorldSaveName, false, bSaveAsync);
-}
 
-void FChunkThread::AsyncSaveVoxelsForRegion(FIntPoint Region, FString SaveName, bool bRemoveDataWhenDone, bool bRunAsync)
-{
-	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::AsyncSaveVoxelsForRegion);
+	for (FIntPoint Region : RegionsToSave)
+		ChunkManagerRef->RegionSaveScheduler.RequestSave(Region, false);
+	ChunkManagerRef->RegionSaveScheduler.WaitForSaves();
 
-	if (IsInGameThread() && bRunAsync)
+	TArray<FIntPoint> RegionsThatFailedToSave{}; // Includes regions that failed to save when they were unloaded, since their edits are in the rotated journal too
+	ChunkManagerRef->RegionSaveScheduler.TakeFailedRegions(RegionsThatFailedToSave);
+
+	if (!RegionsThatFailedToSave.IsEmpty()) // Keep the rotated journal, so a crash before the next save still replays these edits
 	{
-		AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [this, Region, SaveName, bRemoveDataWhenDone]()
-			{
-				SaveVoxelsForRegion(SaveName, Region, bRemoveDataWhenDone);
-			});
+		UE_LOG(LogTemp, Error, TEXT("Failed to save %i regions. They will be saved again next time"), RegionsThatFailedToSave.Num());
+
+		FScopeLock Lock(&ChunkManagerRef->RegionMutex);
+		for (FIntPoint Region : RegionsThatFailedToSave)
+			ChunkManagerRef->RegionsChangedSinceLastSave.AddUnique(Region);
 
+		return;
 	}
-	else
-		SaveVoxelsForRegion(SaveName, Region, bRemoveDataWhenDone);
+
+	if (bRotatedJournal)
+		ChunkManagerRef->EditJournal.DeleteCompactingJournal();
 }
 
-void FChunkThread::SaveVoxelsForRegion(const FString& SaveName, const FIntPoint& Region, bool bRemoveDataWhenDone)
+bool FChunkThread::SaveVoxelsForRegion(const FString& SaveName, const FIntPoint& Region, bool bRemoveDataWhenDone)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::SaveVoxelsForRegion);
+
 	if (SaveName.IsEmpty())
 	{
 		UE_LOG(LogTemp, Error, TEXT("Invalid WorldSaveName: %s"), *SaveName);
 
-		return;
+		return false;
 	}
 
-	bool bRegionWasPendingLoad{};
+	// Loaded first, or we would replace the file with only the edits in memory
+	bool bClaimedRegionLoad{};
 	{
-		FScopeLock Lock(&ChunkManagerRef->RegionMutex);
-		bRegionWasPendingLoad = ChunkManagerRef->RegionsPendingLoad.Contains(Region);
+		FScopeLock LoadLock(&ChunkManagerRef->RegionLoadMutex); // A ChunkThread already loading it finishes first. One waiting on this save loads it after us, and finds it already loaded
+		bool bRegionWasPendingLoad{};
+		{
+			FScopeLock Lock(&ChunkManagerRef->RegionMutex);
+			bRegionWasPendingLoad = ChunkManagerRef->RegionsPendingLoad.Contains(Region) && !ChunkManagerRef->RegionsAlreadyLoaded.Contains(Region);
+			bClaimedRegionLoad = bRegionWasPendingLoad && !ChunkManagerRef->RegionsBeingLoaded.Contains(Region);
+			if (bClaimedRegionLoad)
+				ChunkManagerRef->RegionsBeingLoaded.Add(Region); // So ChunkThreads defer jobs in this region instead of loading it too
+		}
+
+		if (bRegionWasPendingLoad)
+			LoadVoxelsForRegion(Region, SaveName);
+
+		if (bClaimedRegionLoad)
+		{
+			FScopeLock Lock(&ChunkManagerRef->RegionMutex);
+			ChunkManagerRef->RegionsBeingLoaded.Remove(Region);
+		}
 	}
+	if (bClaimedRegionLoad)
+		ChunkManagerRef->ChunkJobQueue.ReleaseDeferredJobs();
 
-	if (bRegionWasPendingLoad)
-		LoadVoxelsForRegion(Region, SaveName);
+	const FString SaveFolderPath{ GetSaveFolderPath(SaveName) };
+	const FString SavePath{ FRegionFile::GetPath(SaveFolderPath, Region) };
 
+	// Only copy what changed while we hold the lock. Encoding and writing happen after, so edits and chunk generation aren't held up by the disk
 	bool bRegionHadModifiedVoxels{};
+	TMap<FIntVector, FModifiedChunkVoxels> ChangedVoxelsByCell{};
+	TMap<FIntVector, FRegionFileRecord> CleanRecordsByCell{}; // Unchanged since the last save, so they are copied from the old file without being encoded again
+	TSet<FIntVector> DirtyCells{};
+	FString OldSavePath{};
 	{
 		FScopeLock Lock(&ChunkManagerRef->ModifiedVoxelsMutex);
-		bRegionHadModifiedVoxels = ChunkManagerRef->ModifiedVoxelsByCellByRegion.Contains(Region);
+		bRegionHadModifiedVoxels = ChunkManagerRef->ModifiedVoxelsByCellByRegion.Contains(Region) || ChunkManagerRef->RegionFilesByRegion.Contains(Region);
+
+		if (bRegionHadModifiedVoxels)
+		{
+			FRegionFileState& RegionFile{ ChunkManagerRef->RegionFilesByRegion.FindOrAdd(Region) }; // Added even before the first save, so SetModifiedVoxels has somewhere to mark edits made while we write
+			OldSavePath = RegionFile.Path;
+			DirtyCells = MoveTemp(RegionFile.DirtyCells); // Edits made while we write mark their cells dirty again
+			CleanRecordsByCell = RegionFile.RecordsByCell;
+		}
+
+		if (const TMap<FIntVector, FModifiedChunkVoxels>* ModifiedVoxelsByCell{ ChunkManagerRef->ModifiedVoxelsByCellByRegion.Find(Region) })
+		{
+			for (const TPair<FIntVector, FModifiedChunkVoxels>& CellVoxelPair : *ModifiedVoxelsByCell)
+			{
+				const FIntVector& Cell = CellVoxelPair.Key;
+				if (CleanRecordsByCell.Contains(Cell) && !DirtyCells.Contains(Cell))
+					continue;
+
+				CleanRecordsByCell.Remove(Cell);
+				ChangedVoxelsByCell.Add(Cell, CellVoxelPair.Value); // Cheap, since most chunks only have a handful of modified voxels
+			}
+		}
 	}
 
 	if (!bRegionHadModifiedVoxels)
@@ -1191,39 +1762,73 @@ void FChunkThread::SaveVoxelsForRegion(const FString& SaveName, const FIntPoint&
 		ChunkManagerRef->RegionsPendingSave.Remove(Region);
 		UE_LOG(LogTemp, Warning, TEXT("No modified voxels to save for region %s"), *Region.ToString());
 
-
-		return;
+		return true;
 	}
 
-	FString SavePath = FPaths::Combine(FPaths::ProjectSavedDir(), SaveFolderName, SaveName, Region.ToString() + "Voxels.dat");
+	// Nothing else replaces this region's file while we run, since the RegionSaveScheduler never saves a region twice at once, so OldSavePath still matches these records without the RegionFileMutex
+	TMap<FIntVector, TArray<uint8>> RecordDataByCell{};
+	bool bSaved{ FRegionFile::ReadRecords(OldSavePath, CleanRecordsByCell, RecordDataByCell) };
+
+	TMap<FIntVector, FRegionFileRecord> SavedRecordsByCell{};
+	if (bSaved)
+	{
+		TArray<uint8> Voxels{};
+		for (const TPair<FIntVector, FModifiedChunkVoxels>& CellVoxelPair : ChangedVoxelsByCell)
+		{
+			CellVoxelPair.Value.ToDense(Voxels, TotalChunkVoxels); // Save files always store the full array layout
+			FVoxelCodec::Encode(Voxels, RecordDataByCell.Add(CellVoxelPair.Key));
+		}
 
-	TArray<FVoxelSaveData> VoxelDataArray{};
+		bSaved = FRegionFile::Write(SavePath, RecordDataByCell, SavedRecordsByCell);
+	}
+	else
+		UE_LOG(LogTemp, Error, TEXT("Failed to copy the unchanged chunks of region %s, so the old save was left alone"), *Region.ToString());
 
+	bool bEditedWhileSaving{};
 	{
+		FScopeLock FileLock(&ChunkManagerRef->RegionFileMutex); // Readers must never see the new file with the old records, or the other way around
+		if (bSaved)
+			bSaved = FRegionFile::CommitWrite(SavePath);
+
 		FScopeLock Lock(&ChunkManagerRef->ModifiedVoxelsMutex);
-		TMap<FIntVector, TArray<uint8>> ModifiedVoxelsByCell{ ChunkManagerRef->ModifiedVoxelsByCellByRegion.FindRef(Region) };
-		for (TPair<FIntVector, TArray<uint8>>& CellVoxelPair : ModifiedVoxelsByCell)
+		FRegionFileState& RegionFile{ ChunkManagerRef->RegionFilesByRegion.FindOrAdd(Region) };
+		if (bSaved && bRemoveDataWhenDone)
 		{
-			const FIntVector& Cell = CellVoxelPair.Key;
-			TArray<uint8>& Voxels = CellVoxelPair.Value;
-			RunLengthEncode(Voxels, Cell);
-			FVoxelSaveData SaveData(Cell, Voxels);
-			VoxelDataArray.Add(SaveData);
+			// Edits can still reach an unloaded region, such as from SetVoxelsInShape, and they aren't in the file we just wrote
+			bEditedWhileSaving = !RegionFile.DirtyCells.IsEmpty();
+			if (const TMap<FIntVector, FModifiedChunkVoxels>* ModifiedVoxelsByCell{ ChunkManagerRef->ModifiedVoxelsByCellByRegion.Find(Region) })
+				for (const TPair<FIntVector, FModifiedChunkVoxels>& CellVoxelPair : *ModifiedVoxelsByCell)
+					if (!SavedRecordsByCell.Contains(CellVoxelPair.Key))
+						bEditedWhileSaving = true;
 		}
-		if (bRemoveDataWhenDone)
+
+		if (bSaved && bRemoveDataWhenDone && !bEditedWhileSaving)
+		{
 			ChunkManagerRef->ModifiedVoxelsByCellByRegion.Remove(Region);
+			ChunkManagerRef->RegionFilesByRegion.Remove(Region);
+		}
+		else if (bSaved)
+		{
+			RegionFile.Path = SavePath;
+			RegionFile.RecordsByCell = MoveTemp(SavedRecordsByCell);
+		}
+		else
+			RegionFile.DirtyCells.Append(DirtyCells); // Still stale on disk, so try them again next save. An unloaded region keeps its data until then
 	}
 
-	TArray<uint8> SerializedData{};
-	FMemoryWriter MemoryWriter(SerializedData, true);
-	MemoryWriter << VoxelDataArray;
+	if (bEditedWhileSaving) // Save it again, and remove it once nothing new came in
+		ChunkManagerRef->RegionSaveScheduler.RequestSave(Region, true);
 
-	FFileHelper::SaveArrayToFile(SerializedData, *SavePath);
+	const FString LegacySavePath{ FPaths::Combine(SaveFolderPath, Region.ToString() + "Voxels.dat") };
+	if (bSaved && FPaths::FileExists(LegacySavePath)) // Everything it held is in the region file now
+		IFileManager::Get().Delete(*LegacySavePath);
 
 	{
 		FScopeLock Lock(&ChunkManagerRef->RegionMutex);
 		ChunkManagerRef->RegionsPendingSave.Remove(Region);
 	}
+
+	return bSaved;
 }
 
 // Do not call from game thread
@@ -1247,22 +1852,31 @@ void FChunkThread::LoadVoxelsForRegion(FIntPoint Region, FString SaveName)
 		return;
 	}
 
-	FString SavePath = FPaths::Combine(FPaths::ProjectSavedDir(), SaveFolderName, SaveName, Region.ToString() + "Voxels.dat");
+	const FString SaveFolderPath{ GetSaveFolderPath(SaveName) };
+	const FString RegionFilePath{ FRegionFile::GetPath(SaveFolderPath, Region) };
 
-	if (!FPaths::FileExists(SavePath))
+	FRegionFile::RecoverInterruptedCommit(RegionFilePath);
+	if (FPaths::FileExists(RegionFilePath))
 	{
-		FScopeLock Lock(&ChunkManagerRef->RegionMutex);
-		ChunkManagerRef->RegionsAlreadyLoaded.Add(Region);
-		ChunkManagerRef->RegionsPendingLoad.Remove(Region);
+		// Only the index is read here. Each chunk's record is read the first time ApplyModifiedVoxelsToChunk needs it
+		TMap<FIntVector, FRegionFileRecord> RecordsByCell{};
+		{
+			FScopeLock FileLock(&ChunkManagerRef->RegionFileMutex);
+			if (!FRegionFile::ReadIndex(RegionFilePath, RecordsByCell))
+				UE_LOG(LogTemp, Error, TEXT("Failed to load the region file index: %s"), *RegionFilePath);
+		}
 
-		return;
-	}
+		for (const TPair<FIntVector, FRegionFileRecord>& CellRecordPair : RecordsByCell)
+			ModifiedAdditionalChunkZIndicesBy2DCell.Modify(FIntPoint(CellRecordPair.Key.X, CellRecordPair.Key.Y), [&CellRecordPair](TArray<int32>& ZIndices) { ZIndices.Add(CellRecordPair.Key.Z); });
 
-	// Read the data from the file
-	TArray<uint8> SerializedData{};
-	if (!FFileHelper::LoadFileToArray(SerializedData, *SavePath))
-	{
-		UE_LOG(LogTemp, Error, TEXT("Failed to load chunk data from file: %s"), *SavePath);
+		if (!RecordsByCell.IsEmpty())
+		{
+			FScopeLock Lock(&ChunkManagerRef->ModifiedVoxelsMutex);
+			ChunkManagerRef->ModifiedVoxelsByCellByRegion.FindOrAdd(Region);
+			FRegionFileState& RegionFile{ ChunkManagerRef->RegionFilesByRegion.FindOrAdd(Region) };
+			RegionFile.Path = RegionFilePath;
+			RegionFile.RecordsByCell = MoveTemp(RecordsByCell);
+		}
 
 		FScopeLock Lock(&ChunkManagerRef->RegionMutex);
 		ChunkManagerRef->RegionsAlreadyLoaded.Add(Region);
@@ -1271,11 +1885,9 @@ void FChunkThread::LoadVoxelsForRegion(FIntPoint Region, FString SaveName)
 		return;
 	}
 
-	FMemoryReader MemoryReader(SerializedData, true);
-	TArray<FVoxelSaveData> VoxelDataArray{};
-	MemoryReader << VoxelDataArray;
+	FString SavePath = FPaths::Combine(SaveFolderPath, Region.ToString() + "Voxels.dat"); // Saves from before region files. The next save of this region converts it
 
-	if (VoxelDataArray.IsEmpty())
+	if (!FPaths::FileExists(SavePath))
 	{
 		FScopeLock Lock(&ChunkManagerRef->RegionMutex);
 		ChunkManagerRef->RegionsAlreadyLoaded.Add(Region);
@@ -1284,26 +1896,124 @@ void FChunkThread::LoadVoxelsForRegion(FIntPoint Region, FString SaveName)
 		return;
 	}
 
-	TMap<FIntVector, TArray<uint8>> ModifiedVoxelsByCell{};
-	for (FVoxelSaveData& VoxelData : VoxelDataArray)
+	// Map the file rather than copying it, and decode each chunk straight out of the mapped view
+	TMap<FIntVector, FModifiedChunkVoxels> ModifiedVoxelsByCell{};
 	{
-		RunLengthDecode(VoxelData.CompressedVoxelData, VoxelData.ChunkCell);
-		ModifiedVoxelsByCell.Add(VoxelData.ChunkCell, VoxelData.CompressedVoxelData);
-		FVector2D HeightmapLocation{ FVector2D(FVector(VoxelData.ChunkCell * ChunkSize)) };
-		FScopeLock Lock(&ChunkZMutex);
-		ModifiedAdditionalChunkZIndicesBy2DCell.FindOrAdd(FIntPoint(VoxelData.ChunkCell.X, VoxelData.ChunkCell.Y)).Add(VoxelData.ChunkCell.Z);
+		FScopeLock FileLock(&ChunkManagerRef->RegionFileMutex); // A save deletes this file once it has converted it, which some platforms refuse while it's mapped. Released before the RegionMutex is taken
+		FMappedFileView MappedFile{};
+		TArray<uint8> SerializedData{};
+		TConstArrayView<uint8> FileData{};
+		if (MappedFile.Open(SavePath))
+			FileData = MappedFile.GetData();
+		else if (FFileHelper::LoadFileToArray(SerializedData, *SavePath))
+			FileData = SerializedData;
+		else
+			UE_LOG(LogTemp, Error, TEXT("Failed to load chunk data from file: %s"), *SavePath);
+
+		// Same layout FMemoryWriter gave a TArray<FVoxelSaveData>. Each element's voxels are read in place instead of into their own array
+		FMemoryReaderView MemoryReader(FileData, true);
+		int32 VoxelDataCount{};
+		if (!FileData.IsEmpty())
+			MemoryReader << VoxelDataCount;
+
+		for (int32 VoxelDataIndex{}; VoxelDataIndex < VoxelDataCount && !MemoryReader.IsError(); VoxelDataIndex++)
+		{
+			FIntVector ChunkCell{};
+			int32 CompressedVoxelNum{};
+			MemoryReader << ChunkCell << CompressedVoxelNum;
+
+			const int64 CompressedVoxelsStart{ MemoryReader.Tell() };
+			if (MemoryReader.IsError() || CompressedVoxelNum < 0 || CompressedVoxelsStart + CompressedVoxelNum > FileData.Num())
+			{
+				UE_LOG(LogTemp, Error, TEXT("Chunk data file is truncated: %s"), *SavePath);
+				break;
+			}
+
+			TArray<uint8> Voxels{};
+			RunLengthDecode(FileData.Slice(CompressedVoxelsStart, CompressedVoxelNum), Voxels);
+			MemoryReader.Seek(CompressedVoxelsStart + CompressedVoxelNum);
+
+			ModifiedVoxelsByCell.Add(ChunkCell, FModifiedChunkVoxels(MoveTemp(Voxels)));
+			ModifiedAdditionalChunkZIndicesBy2DCell.Modify(FIntPoint(ChunkCell.X, ChunkCell.Y), [&ChunkCell](TArray<int32>& ZIndices) { ZIndices.Add(ChunkCell.Z); });
+		}
+
+		if (!ModifiedVoxelsByCell.IsEmpty())
+		{
+			FScopeLock Lock(&ChunkManagerRef->ModifiedVoxelsMutex);
+			TMap<FIntVector, FModifiedChunkVoxels>& LoadedVoxelsByCell{ ChunkManagerRef->ModifiedVoxelsByCellByRegion.FindOrAdd(Region) };
+			TArray<uint8> Voxels{};
+			for (TPair<FIntVector, FModifiedChunkVoxels>& CellVoxelPair : ModifiedVoxelsByCell)
+			{
+				FModifiedChunkVoxels* UnsavedVoxels{ LoadedVoxelsByCell.Find(CellVoxelPair.Key) };
+				if (!UnsavedVoxels)
+				{
+					LoadedVoxelsByCell.Add(CellVoxelPair.Key, MoveTemp(CellVoxelPair.Value));
+					continue;
+				}
+
+				// Edited since this file was written, such as while the region was unloaded, so those edits win over the file
+				CellVoxelPair.Value.ToDense(Voxels, TotalChunkVoxels);
+				UnsavedVoxels->ApplyToVoxels(Voxels);
+				*UnsavedVoxels = FModifiedChunkVoxels(MoveTemp(Voxels));
+			}
+		}
 	}
 
+	FScopeLock Lock(&ChunkManagerRef->RegionMutex);
+	ChunkManagerRef->RegionsAlreadyLoaded.Add(Region);
+	ChunkManagerRef->RegionsPendingLoad.Remove(Region);
+}
+
+void FChunkThread::RecoverEditJournal()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::RecoverEditJournal);
+
+	struct FJournaledEdits
 	{
-		FScopeLock Lock(&ChunkManagerRef->ModifiedVoxelsMutex);
-		ChunkManagerRef->ModifiedVoxelsByCellByRegion.Add(Region, ModifiedVoxelsByCell);
-	}
+		TArray<int32> VoxelIndices{};
+		TArray<uint8> VoxelValues{};
+	};
+
+	const FString SaveFolderPath{ GetSaveFolderPath(WorldSaveName) };
+	TMap<FIntPoint, TMap<FIntVector, FJournaledEdits>> EditsByCellByRegion{};
+	FEditJournal::ReadPendingEdits(SaveFolderPath, [this, &EditsByCellByRegion](const FIntVector& ChunkCell, int32 VoxelIndex, uint8 VoxelValue)
+		{
+			FJournaledEdits& Edits{ EditsByCellByRegion.FindOrAdd(GetRegionByCell(FIntPoint(ChunkCell.X, ChunkCell.Y))).FindOrAdd(ChunkCell) };
+			Edits.VoxelIndices.Add(VoxelIndex);
+			Edits.VoxelValues.Add(VoxelValue);
+		});
 
+	for (const TPair<FIntPoint, TMap<FIntVector, FJournaledEdits>>& RegionEditsPair : EditsByCellByRegion)
 	{
+		const FIntPoint& Region{ RegionEditsPair.Key };
+		UE_LOG(LogTemp, Warning, TEXT("Recovering unsaved voxel edits for region %s from the edit journal"), *Region.ToString());
+
+		bool bRegionWasPendingLoad{};
+		{
+			FScopeLock Lock(&ChunkManagerRef->RegionMutex);
+			bRegionWasPendingLoad = ChunkManagerRef->RegionsPendingLoad.Contains(Region);
+		}
+
+		// Replayed in the order they were made, so the newest value of each voxel wins even if the region file already had some of them
+		LoadVoxelsForRegion(Region, WorldSaveName);
+		for (const TPair<FIntVector, FJournaledEdits>& CellEditsPair : RegionEditsPair.Value)
+			ChunkManagerRef->SetModifiedVoxels(CellEditsPair.Key, CellEditsPair.Value.VoxelIndices, CellEditsPair.Value.VoxelValues);
+
+		ChunkManagerRef->RegionSaveScheduler.RequestSave(Region, true); // Requested before the region is marked unloaded, so TryLoadRegion waits for it
+
 		FScopeLock Lock(&ChunkManagerRef->RegionMutex);
-		ChunkManagerRef->RegionsAlreadyLoaded.Add(Region);
-		ChunkManagerRef->RegionsPendingLoad.Remove(Region);
+		ChunkManagerRef->RegionsAlreadyLoaded.Remove(Region); // Loaded again from the updated file once a player needs it
+		if (bRegionWasPendingLoad)
+			ChunkManagerRef->RegionsPendingLoad.AddUnique(Region);
 	}
+	ChunkManagerRef->RegionSaveScheduler.WaitForSaves();
+
+	TArray<FIntPoint> RegionsThatFailedToSave{};
+	ChunkManagerRef->RegionSaveScheduler.TakeFailedRegions(RegionsThatFailedToSave);
+	if (RegionsThatFailedToSave.IsEmpty())
+		FEditJournal::DeletePendingJournals(SaveFolderPath);
+	else
+		UE_LOG(LogTemp, Error, TEXT("Failed to save every region recovered from the edit journal. The journal is kept so they are recovered again next time"));
 }
 
 void FChunkThread::GetRegionsToSave(TArray<FIntPoint>& RegionsToSave)
@@ -1348,19 +2058,7 @@ void FChunkThread::SetChunkGenRadius(int32 Radius)
 	}
 
 	bWasRangeChanged = true;
-	ChunkGenerationRadius = Radius;     
-	LastRingCount = 0;
-	for (int32 TrackedActorIndex{}; TrackedActorIndex < PlayerLocations.Num(); TrackedActorIndex++)
-	{
-		if (!TrackedChunkRingDistance.IsValidIndex(TrackedActorIndex))
-			continue;
-		TrackedChunkRingDistance[TrackedActorIndex] = FMath::Min(TrackedChunkRingDistance[TrackedActorIndex], Radius);
-
-		if (!TrackedChunkRingCount.IsValidIndex(TrackedActorIndex))
-			continue;
-
-		TrackedChunkRingCount[TrackedActorIndex] = FMath::Min(TrackedChunkRingCount[TrackedActorIndex], ChunkGenerationRadius * 1.4);
-	}
+	ChunkGenerationRadius = Radius;
 }
 
 void FChunkThread::GetVoxelIndex(int32& VoxelIndex, int32& X, int32& Y, int32& Z)
@@ -1448,6 +2146,7 @@ bool FChunkThread::EnableReplicationForChunk(AChunkActor* Chunk, bool bShouldDir
 			UE_LOG(LogTemp, Error, TEXT("Failed to rename Chunk %s to %s!"), *Chunk->GetName(), *NewName);
 			return false;
 		}
+		Chunk->bHasReplicatedName = true;
 
 		if (bShouldDirectlySetbReplicates)
 			Chunk->bReplicates = true;
@@ -1543,67 +2242,3 @@ TArray<FString> FChunkThread::GetSaveFoldersNames()
 
 	return SaveFolderNames;
 }
-
-void RunLengthEncode(TArray<uint8>& VoxelData, FIntVector OwningChunkCell)
-{
-	TRACE_CPUPROFILER_EVENT_SCOPE(RunLengthEncode);
-
-	if (VoxelData.IsEmpty())
-	{
-		UE_LOG(LogTemp, Warning, TEXT("Input data was empty. No Voxels to RunLengthEncode"));
-		return;
-	}
-
-	TArray<uint8> EncodedData;
-	EncodedData.Reserve(VoxelData.Num() / 2);
-
-	int32 CurrentCount{ 1 };
-	uint8 CurrentValue{ VoxelData[0] };
-
-	for (int32 VoxelIndex{ 1 }; VoxelIndex < VoxelData.Num(); ++VoxelIndex)
-	{
-		if (VoxelData[VoxelIndex] == CurrentValue && CurrentCount < MAX_uint8)
-			++CurrentCount;
-		else
-		{
-			EncodedData.Add(CurrentCount);
-			EncodedData.Add(CurrentValue);
-			CurrentCount = 1;
-			CurrentValue = VoxelData[VoxelIndex];
-		}
-	}
-
-	EncodedData.Add(CurrentCount);
-	EncodedData.Add(CurrentValue);
-
-	VoxelData = MoveTemp(EncodedData);
-}
-
-void RunLengthDecode(TArray<uint8>& EncodedData, FIntVector OwningChunkCell)
-{
-	TRACE_CPUPROFILER_EVENT_SCOPE(RunLengthDecode);
-
-	if (EncodedData.IsEmpty())
-	{
-		UE_LOG(LogTemp, Warning, TEXT("Input data was empty. No Voxels to RunLengthDecode"));
-		return;
-	}
-
-	int32 DecodedSize{ 0 };
-	for (int32 Index{ 0 }; Index < EncodedData.Num(); Index += 2)
-		DecodedSize += EncodedData[Index];
-
-	TArray<uint8> DecodedData{};
-	DecodedData.Reserve(DecodedSize);
-
-	for (int32 Index{ 0 }; Index < EncodedData.Num(); Index += 2)
-	{
-		uint8 Count{ EncodedData[Index] };
-		uint8 Value{ EncodedData[Index + 1] };
-
-		for (int32 ValueIndex{ 0 }; ValueIndex < Count; ++ValueIndex)
-			DecodedData.Add(Value);
-	}
-
-	EncodedData = MoveTemp(DecodedData);
-}
\ No newline at end of file
@@ -0,0 +1,172 @@
+// Copyright(c) 2024 Endless98. All Rights Reserved.
+
+#include "EditJournal.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	constexpr int64 RecordHeaderSize{ sizeof(int32) * 3 + sizeof(int32) }; // Cell, EditCount
+	constexpr int64 EditSize{ sizeof(int32) + sizeof(uint8) };             // VoxelIndex, VoxelValue
+}
+
+FEditJournal::~FEditJournal()
+{
+	Close();
+}
+
+bool FEditJournal::Open(const FString& SaveFolderPath)
+{
+	FScopeLock Lock(&JournalMutex);
+	JournalFolderPath = SaveFolderPath;
+	IFileManager::Get().MakeDirectory(*JournalFolderPath, true);
+
+	return OpenActiveJournal();
+}
+
+void FEditJournal::Close()
+{
+	FScopeLock Lock(&JournalMutex);
+	ActiveJournal.Reset();
+}
+
+bool FEditJournal::IsOpen() const
+{
+	FScopeLock Lock(&JournalMutex);
+	return ActiveJournal.IsValid();
+}
+
+void FEditJournal::Append(const FIntVector& ChunkCell, const TArray<int32>& VoxelIndices, const TArray<uint8>& VoxelValues)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FEditJournal::Append);
+
+	FScopeLock Lock(&JournalMutex);
+	if (!ActiveJournal)
+		return;
+
+	const int32 EditCount{ FMath::Min(VoxelIndices.Num(), VoxelValues.Num()) };
+	RecordBuffer.Reset();
+	FMemoryWriter RecordWriter(RecordBuffer);
+
+	int32 CellX{ ChunkCell.X };
+	int32 CellY{ ChunkCell.Y };
+	int32 CellZ{ ChunkCell.Z };
+	int32 WrittenEditCount{ EditCount };
+	RecordWriter << CellX << CellY << CellZ << WrittenEditCount;
+	for (int32 EditIndex{}; EditIndex < EditCount; EditIndex++)
+	{
+		int32 VoxelIndex{ VoxelIndices[EditIndex] };
+		uint8 VoxelValue{ VoxelValues[EditIndex] };
+		RecordWriter << VoxelIndex << VoxelValue;
+	}
+
+	// Flushing hands the record to the OS, so it survives the game crashing even though it may not have reached the disk yet
+	if (!ActiveJournal->Write(RecordBuffer.GetData(), RecordBuffer.Num()) || !ActiveJournal->Flush())
+		UE_LOG(LogTemp, Error, TEXT("Failed to append voxel edits for ChunkCell %s to the edit journal"), *ChunkCell.ToString());
+}
+
+bool FEditJournal::Rotate()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FEditJournal::Rotate);
+
+	FScopeLock Lock(&JournalMutex);
+	if (!ActiveJournal)
+		return false;
+
+	ActiveJournal.Reset();
+
+	const FString ActivePath{ GetActivePath(JournalFolderPath) };
+	const FString CompactingPath{ GetCompactingPath(JournalFolderPath) };
+	bool bRotated{};
+	if (FPaths::FileExists(CompactingPath)) // The last compaction didn't finish, so its edits still need saving along with these
+	{
+		TArray<uint8> ActiveJournalData{};
+		bRotated = FFileHelper::LoadFileToArray(ActiveJournalData, *ActivePath) && FFileHelper::SaveArrayToFile(ActiveJournalData, *CompactingPath, &IFileManager::Get(), FILEWRITE_Append);
+		if (bRotated)
+			IFileManager::Get().Delete(*ActivePath);
+	}
+	else
+		bRotated = IFileManager::Get().Move(*CompactingPath, *ActivePath);
+
+	if (!bRotated)
+		UE_LOG(LogTemp, Error, TEXT("Failed to rotate the edit journal in %s. Its edits stay in the active journal"), *JournalFolderPath);
+
+	OpenActiveJournal();
+	return bRotated;
+}
+
+void FEditJournal::DeleteCompactingJournal()
+{
+	FScopeLock Lock(&JournalMutex);
+	if (!JournalFolderPath.IsEmpty())
+		IFileManager::Get().Delete(*GetCompactingPath(JournalFolderPath));
+}
+
+void FEditJournal::ReadPendingEdits(const FString& SaveFolderPath, TFunctionRef<void(const FIntVector&, int32, uint8)> EditVisitor)
+{
+	ReadEdits(GetCompactingPath(SaveFolderPath), EditVisitor);
+	ReadEdits(GetActivePath(SaveFolderPath), EditVisitor);
+}
+
+void FEditJournal::DeletePendingJournals(const FString& SaveFolderPath)
+{
+	IFileManager::Get().Delete(*GetCompactingPath(SaveFolderPath));
+	IFileManager::Get().Delete(*GetActivePath(SaveFolderPath));
+}
+
+FString FEditJournal::GetActivePath(const FString& SaveFolderPath)
+{
+	return FPaths::Combine(SaveFolderPath, TEXT("Edits.journal"));
+}
+
+FString FEditJournal::GetCompactingPath(const FString& SaveFolderPath)
+{
+	return FPaths::Combine(SaveFolderPath, TEXT("Edits.journal.compacting"));
+}
+
+void FEditJournal::ReadEdits(const FString& Path, TFunctionRef<void(const FIntVector&, int32, uint8)> EditVisitor)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FEditJournal::ReadEdits);
+
+	TArray<uint8> JournalData{};
+	if (!FPaths::FileExists(Path) || !FFileHelper::LoadFileToArray(JournalData, *Path))
+		return;
+
+	FMemoryReader JournalReader(JournalData);
+	while (JournalReader.TotalSize() - JournalReader.Tell() >= RecordHeaderSize)
+	{
+		FIntVector ChunkCell{};
+		int32 EditCount{};
+		JournalReader << ChunkCell.X << ChunkCell.Y << ChunkCell.Z << EditCount;
+
+		if (EditCount < 0 || JournalReader.TotalSize() - JournalReader.Tell() < EditCount * EditSize) // The game stopped partway through appending this record
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Edit journal %s ends with an incomplete record, which was skipped"), *Path);
+			return;
+		}
+
+		for (int32 EditIndex{}; EditIndex < EditCount; EditIndex++)
+		{
+			int32 VoxelIndex{};
+			uint8 VoxelValue{};
+			JournalReader << VoxelIndex << VoxelValue;
+			EditVisitor(ChunkCell, VoxelIndex, VoxelValue);
+		}
+	}
+}
+
+bool FEditJournal::OpenActiveJournal()
+{
+	ActiveJournal.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*GetActivePath(JournalFolderPath), true));
+	if (!ActiveJournal)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to open the edit journal in %s. Edits will only be saved by autosave"), *JournalFolderPath);
+		return false;
+	}
+
+	return true;
+}
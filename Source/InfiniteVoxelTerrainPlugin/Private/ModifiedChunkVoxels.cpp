@@ -0,0 +1,108 @@
+// Copyright(c) 2024 Endless98. All Rights Reserved.
+
+#include "ModifiedChunkVoxels.h"
+#include "Algo/BinarySearch.h"
+
+FModifiedChunkVoxels::FModifiedChunkVoxels(TArray<uint8>&& InDenseVoxels)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FModifiedChunkVoxels::FModifiedChunkVoxels);
+
+	int32 ModifiedVoxelCount{};
+	for (uint8 VoxelValue : InDenseVoxels)
+		if (VoxelValue != UINT8_MAX)
+			ModifiedVoxelCount++;
+
+	if (ShouldBeDense(ModifiedVoxelCount, InDenseVoxels.Num()))
+	{
+		DenseVoxels = MoveTemp(InDenseVoxels);
+		return;
+	}
+
+	SparseIndices.Reserve(ModifiedVoxelCount);
+	SparseValues.Reserve(ModifiedVoxelCount);
+	for (int32 VoxelIndex{}; VoxelIndex < InDenseVoxels.Num(); VoxelIndex++) // Walking in order keeps SparseIndices sorted
+	{
+		if (InDenseVoxels[VoxelIndex] == UINT8_MAX)
+			continue;
+
+		SparseIndices.Add(VoxelIndex);
+		SparseValues.Add(InDenseVoxels[VoxelIndex]);
+	}
+}
+
+void FModifiedChunkVoxels::SetVoxel(int32 VoxelIndex, uint8 VoxelValue, int32 TotalChunkVoxels)
+{
+	if (VoxelIndex < 0 || VoxelIndex >= TotalChunkVoxels)
+		return;
+
+	if (IsDense())
+	{
+		if (DenseVoxels.IsValidIndex(VoxelIndex))
+			DenseVoxels[VoxelIndex] = VoxelValue;
+		return;
+	}
+
+	const int32 SparseIndex{ static_cast<int32>(Algo::LowerBound(SparseIndices, VoxelIndex)) };
+	if (SparseIndices.IsValidIndex(SparseIndex) && SparseIndices[SparseIndex] == VoxelIndex)
+	{
+		SparseValues[SparseIndex] = VoxelValue;
+		return;
+	}
+
+	SparseIndices.Insert(VoxelIndex, SparseIndex);
+	SparseValues.Insert(VoxelValue, SparseIndex);
+
+	if (ShouldBeDense(SparseIndices.Num(), TotalChunkVoxels))
+		PromoteToDense(TotalChunkVoxels);
+}
+
+bool FModifiedChunkVoxels::ApplyToVoxels(TArray<uint8>& Voxels) const
+{
+	if (IsDense())
+	{
+		if (DenseVoxels.Num() != Voxels.Num())
+			return false;
+
+		for (int32 VoxelIndex{}; VoxelIndex < DenseVoxels.Num(); VoxelIndex++) // UINT8_MAX indicates the voxel has not been modified
+			if (DenseVoxels[VoxelIndex] != UINT8_MAX)
+				Voxels[VoxelIndex] = DenseVoxels[VoxelIndex];
+		return true;
+	}
+
+	if (!SparseIndices.IsEmpty() && !Voxels.IsValidIndex(SparseIndices.Last())) // The indices are sorted, so if the last one fits they all do
+		return false;
+
+	for (int32 SparseIndex{}; SparseIndex < SparseIndices.Num(); SparseIndex++)
+		Voxels[SparseIndices[SparseIndex]] = SparseValues[SparseIndex];
+	return true;
+}
+
+void FModifiedChunkVoxels::ToDense(TArray<uint8>& OutVoxels, int32 TotalChunkVoxels) const
+{
+	if (IsDense())
+	{
+		OutVoxels = DenseVoxels;
+		return;
+	}
+
+	OutVoxels.Init(UINT8_MAX, TotalChunkVoxels);
+	for (int32 SparseIndex{}; SparseIndex < SparseIndices.Num(); SparseIndex++)
+		if (OutVoxels.IsValidIndex(SparseIndices[SparseIndex]))
+			OutVoxels[SparseIndices[SparseIndex]] = SparseValues[SparseIndex];
+}
+
+bool FModifiedChunkVoxels::ShouldBeDense(int32 ModifiedVoxelCount, int32 TotalChunkVoxels)
+{
+	// Past a quarter of the full array's size the list barely saves memory, and every insert has to shift more of it
+	constexpr int32 SparseBytesPerVoxel{ sizeof(int32) + sizeof(uint8) };
+	return ModifiedVoxelCount * SparseBytesPerVoxel > TotalChunkVoxels / 4;
+}
+
+void FModifiedChunkVoxels::PromoteToDense(int32 TotalChunkVoxels)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FModifiedChunkVoxels::PromoteToDense);
+
+	ToDense(DenseVoxels, TotalChunkVoxels);
+	SparseIndices.Empty();
+	SparseValues.Empty();
+}
@@ -0,0 +1,117 @@
+// Copyright(c) 2024 Endless98. All Rights Reserved.
+
+#include "PaletteVoxelStorage.h"
+
+void FPaletteVoxelStorage::Pack(const TArray<uint8>& Voxels)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FPaletteVoxelStorage::Pack);
+
+	int16 PaletteIndexByValue[UINT8_MAX + 1];
+	FMemory::Memset(PaletteIndexByValue, 0xFF, sizeof(PaletteIndexByValue)); // Every entry starts at -1
+
+	Palette.Reset();
+	for (uint8 VoxelValue : Voxels)
+	{
+		if (PaletteIndexByValue[VoxelValue] >= 0)
+			continue;
+
+		PaletteIndexByValue[VoxelValue] = static_cast<int16>(Palette.Add(VoxelValue));
+	}
+
+	VoxelNum = Voxels.Num();
+	BitsPerVoxel = GetBitsForPaletteSize(Palette.Num());
+	VoxelsPerWordShift = BitsPerVoxel > 0 ? 5 - FMath::FloorLog2(BitsPerVoxel) : 0;
+	PaletteIndexMask = BitsPerVoxel > 0 ? (1u << BitsPerVoxel) - 1 : 0;
+
+	PackedIndices.Reset();
+	if (BitsPerVoxel == 0)
+		return;
+
+	PackedIndices.SetNumZeroed(FMath::DivideAndRoundUp(VoxelNum, 1 << VoxelsPerWordShift));
+	for (int32 VoxelIndex{}; VoxelIndex < VoxelNum; VoxelIndex++)
+		SetPaletteIndex(VoxelIndex, PaletteIndexByValue[Voxels[VoxelIndex]]);
+}
+
+void FPaletteVoxelStorage::Unpack(TArray<uint8>& OutVoxels) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FPaletteVoxelStorage::Unpack);
+
+	OutVoxels.SetNumUninitialized(VoxelNum);
+	if (VoxelNum == 0)
+		return;
+
+	if (BitsPerVoxel == 0)
+	{
+		FMemory::Memset(OutVoxels.GetData(), Palette[0], VoxelNum);
+		return;
+	}
+
+	for (int32 VoxelIndex{}; VoxelIndex < VoxelNum; VoxelIndex++)
+		OutVoxels[VoxelIndex] = Palette[GetPaletteIndex(VoxelIndex)];
+}
+
+void FPaletteVoxelStorage::Empty()
+{
+	Palette.Empty();
+	PackedIndices.Empty();
+	VoxelNum = 0;
+	BitsPerVoxel = 0;
+	VoxelsPerWordShift = 0;
+	PaletteIndexMask = 0;
+}
+
+uint8 FPaletteVoxelStorage::GetVoxel(int32 VoxelIndex) const
+{
+	return Palette[GetPaletteIndex(VoxelIndex)];
+}
+
+void FPaletteVoxelStorage::SetVoxel(int32 VoxelIndex, uint8 VoxelValue)
+{
+	int32 PaletteIndex{ Palette.Find(VoxelValue) };
+	if (PaletteIndex == INDEX_NONE)
+	{
+		if (Palette.Num() >= (1 << BitsPerVoxel)) // No room at this bit width. Repacking also drops palette values no voxel uses anymore
+		{
+			TArray<uint8> Voxels{};
+			Unpack(Voxels);
+			Voxels[VoxelIndex] = VoxelValue;
+			Pack(Voxels);
+			return;
+		}
+		PaletteIndex = Palette.Add(VoxelValue);
+	}
+
+	SetPaletteIndex(VoxelIndex, PaletteIndex);
+}
+
+int32 FPaletteVoxelStorage::GetBitsForPaletteSize(int32 PaletteSize)
+{
+	if (PaletteSize <= 1)
+		return 0;
+	if (PaletteSize <= 2)
+		return 1;
+	if (PaletteSize <= 4)
+		return 2;
+	if (PaletteSize <= 16)
+		return 4;
+	return 8;
+}
+
+uint32 FPaletteVoxelStorage::GetPaletteIndex(int32 VoxelIndex) const
+{
+	if (BitsPerVoxel == 0)
+		return 0;
+
+	const int32 BitOffset{ (VoxelIndex & ((1 << VoxelsPerWordShift) - 1)) * BitsPerVoxel };
+	return (PackedIndices[VoxelIndex >> VoxelsPerWordShift] >> BitOffset) & PaletteIndexMask;
+}
+
+void FPaletteVoxelStorage::SetPaletteIndex(int32 VoxelIndex, uint32 PaletteIndex)
+{
+	if (BitsPerVoxel == 0)
+		return;
+
+	const int32 BitOffset{ (VoxelIndex & ((1 << VoxelsPerWordShift) - 1)) * BitsPerVoxel };
+	uint32& Word{ PackedIndices[VoxelIndex >> VoxelsPerWordShift] };
+	Word = (Word & ~(PaletteIndexMask << BitOffset)) | ((PaletteIndex & PaletteIndexMask) << BitOffset);
+}
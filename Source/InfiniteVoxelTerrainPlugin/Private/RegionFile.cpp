@@ -0,0 +1,278 @@
+// Copyright(c) 2024 Endless98. All Rights Reserved.
+
+#include "RegionFile.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+bool FMappedFileView::Open(const FString& Path)
+{
+	MappedRegion.Reset();
+	FileHandle.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Path));
+	if (!FileHandle)
+		return false;
+
+	const int64 FileSize{ FileHandle->GetFileSize() };
+	if (FileSize <= 0 || FileSize > MAX_int32) // Nothing to map, or too big for an array view
+	{
+		FileHandle.Reset();
+		return false;
+	}
+
+	MappedRegion.Reset(FileHandle->MapRegion(0, FileSize));
+	if (!MappedRegion)
+	{
+		FileHandle.Reset();
+		return false;
+	}
+
+	return true;
+}
+
+TConstArrayView<uint8> FMappedFileView::GetData() const
+{
+	if (!MappedRegion)
+		return TConstArrayView<uint8>();
+
+	return TConstArrayView<uint8>(MappedRegion->GetMappedPtr(), static_cast<int32>(MappedRegion->GetMappedSize()));
+}
+
+FString FRegionFile::GetPath(const FString& SaveFolderPath, const FIntPoint& Region)
+{
+	return FPaths::Combine(SaveFolderPath, Region.ToString() + "Voxels.ivr");
+}
+
+bool FRegionFile::ReadIndex(const FString& Path, TMap<FIntVector, FRegionFileRecord>& OutRecordsByCell)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FRegionFile::ReadIndex);
+
+	OutRecordsByCell.Reset();
+
+	FMappedFileView MappedFile{};
+	if (MappedFile.Open(Path)) // Only the pages holding the index are actually read
+		return ReadIndexFromData(Path, MappedFile.GetData(), MappedFile.GetData().Num(), OutRecordsByCell);
+
+	TUniquePtr<IFileHandle> FileHandle{ FPlatformFileManager::Get().GetPlatformFile().OpenRead(*Path) };
+	if (!FileHandle)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to open region file: %s"), *Path);
+		return false;
+	}
+
+	const int64 FileSize{ FileHandle->Size() };
+	TArray<uint8> HeaderAndIndexData{};
+	HeaderAndIndexData.SetNumUninitialized(HeaderSize);
+	if (FileSize < HeaderSize || !FileHandle->Read(HeaderAndIndexData.GetData(), HeaderSize))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Region file is too small to have a header: %s"), *Path);
+		return false;
+	}
+
+	uint32 Magic{};
+	uint32 Version{};
+	int32 RecordCount{};
+	FMemoryReaderView HeaderReader(HeaderAndIndexData);
+	HeaderReader << Magic << Version << RecordCount;
+	const int64 IndexSize{ FMath::Clamp<int64>(RecordCount * IndexEntrySize, 0, FileSize - HeaderSize) }; // A bad count is caught by ReadIndexFromData
+	HeaderAndIndexData.AddUninitialized(IndexSize);
+	if (!FileHandle->Read(HeaderAndIndexData.GetData() + HeaderSize, IndexSize))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to read the index of region file: %s"), *Path);
+		return false;
+	}
+
+	return ReadIndexFromData(Path, HeaderAndIndexData, FileSize, OutRecordsByCell);
+}
+
+bool FRegionFile::VisitRecords(const FString& Path, const TMap<FIntVector, FRegionFileRecord>& RecordsByCell, TFunctionRef<void(const FIntVector&, TConstArrayView<uint8>)> Visitor)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FRegionFile::VisitRecords);
+
+	if (RecordsByCell.IsEmpty())
+		return true;
+
+	FMappedFileView MappedFile{};
+	if (MappedFile.Open(Path))
+	{
+		const TConstArrayView<uint8> FileData{ MappedFile.GetData() };
+		for (const TPair<FIntVector, FRegionFileRecord>& CellRecordPair : RecordsByCell)
+		{
+			const FRegionFileRecord& Record{ CellRecordPair.Value };
+			if (Record.Offset < 0 || Record.Length <= 0 || Record.Offset + Record.Length > FileData.Num())
+			{
+				UE_LOG(LogTemp, Error, TEXT("Region file %s is smaller than its record for cell %s"), *Path, *CellRecordPair.Key.ToString());
+				return false;
+			}
+
+			Visitor(CellRecordPair.Key, FileData.Slice(Record.Offset, Record.Length));
+		}
+
+		return true;
+	}
+
+	TUniquePtr<IFileHandle> FileHandle{ FPlatformFileManager::Get().GetPlatformFile().OpenRead(*Path) };
+	if (!FileHandle)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to open region file: %s"), *Path);
+		return false;
+	}
+
+	TArray<uint8> RecordData{};
+	for (const TPair<FIntVector, FRegionFileRecord>& CellRecordPair : RecordsByCell)
+	{
+		if (!ReadRecordFromHandle(*FileHandle, CellRecordPair.Value, RecordData))
+			return false;
+
+		Visitor(CellRecordPair.Key, RecordData);
+	}
+
+	return true;
+}
+
+bool FRegionFile::ReadRecords(const FString& Path, const TMap<FIntVector, FRegionFileRecord>& RecordsByCell, TMap<FIntVector, TArray<uint8>>& OutRecordDataByCell)
+{
+	return VisitRecords(Path, RecordsByCell, [&OutRecordDataByCell](const FIntVector& Cell, TConstArrayView<uint8> RecordData)
+		{
+			OutRecordDataByCell.Add(Cell, TArray<uint8>(RecordData.GetData(), RecordData.Num()));
+		});
+}
+
+bool FRegionFile::Write(const FString& Path, const TMap<FIntVector, TArray<uint8>>& RecordDataByCell, TMap<FIntVector, FRegionFileRecord>& OutRecordsByCell)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FRegionFile::Write);
+
+	OutRecordsByCell.Reset();
+	OutRecordsByCell.Reserve(RecordDataByCell.Num());
+
+	int32 RecordCount{};
+	for (const TPair<FIntVector, TArray<uint8>>& CellDataPair : RecordDataByCell)
+		if (!CellDataPair.Value.IsEmpty()) // An empty record would fail validation when read back
+			RecordCount++;
+
+	// Lay out every record first so the index can be written ahead of them
+	int64 NextRecordOffset{ HeaderSize + RecordCount * IndexEntrySize };
+	for (const TPair<FIntVector, TArray<uint8>>& CellDataPair : RecordDataByCell)
+	{
+		if (CellDataPair.Value.IsEmpty())
+			continue;
+
+		OutRecordsByCell.Add(CellDataPair.Key, FRegionFileRecord{ NextRecordOffset, CellDataPair.Value.Num() });
+		NextRecordOffset += CellDataPair.Value.Num();
+	}
+
+	TArray<uint8> FileData{};
+	FileData.Reserve(NextRecordOffset);
+	FMemoryWriter FileWriter(FileData);
+
+	uint32 Magic{ FileMagic };
+	uint32 Version{ FileVersion };
+	FileWriter << Magic << Version << RecordCount;
+
+	for (TPair<FIntVector, FRegionFileRecord>& CellRecordPair : OutRecordsByCell)
+		FileWriter << CellRecordPair.Key.X << CellRecordPair.Key.Y << CellRecordPair.Key.Z << CellRecordPair.Value.Offset << CellRecordPair.Value.Length;
+
+	for (const TPair<FIntVector, TArray<uint8>>& CellDataPair : RecordDataByCell) // Same order the offsets were handed out in
+		FileData.Append(CellDataPair.Value);
+
+	const FString TempPath{ GetTempPath(Path) };
+	if (!FFileHelper::SaveArrayToFile(FileData, *TempPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to write region file: %s"), *TempPath);
+		IFileManager::Get().Delete(*TempPath);
+		OutRecordsByCell.Reset();
+		return false;
+	}
+
+	return true;
+}
+
+bool FRegionFile::CommitWrite(const FString& Path)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FRegionFile::CommitWrite);
+
+	const FString TempPath{ GetTempPath(Path) };
+	if (FPlatformFileManager::Get().GetPlatformFile().MoveFile(*Path, *TempPath)) // POSIX platforms rename over the old file in one step. Windows refuses while the old file exists, so saves there always take the path below
+		return true;
+
+	if (!IFileManager::Get().Move(*Path, *TempPath, true)) // Deletes the old file before renaming, which isn't atomic, so RecoverInterruptedCommit finishes the job if we crash in between
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to replace region file %s with %s"), *Path, *TempPath);
+		return false;
+	}
+
+	return true;
+}
+
+void FRegionFile::RecoverInterruptedCommit(const FString& Path)
+{
+	const FString TempPath{ GetTempPath(Path) };
+	if (FPaths::FileExists(Path) || !FPaths::FileExists(TempPath))
+		return;
+
+	TMap<FIntVector, FRegionFileRecord> RecordsByCell{};
+	if (!ReadIndex(TempPath, RecordsByCell)) // A temp file we crashed partway through writing fails this, and the old file is still whole in that case
+	{
+		IFileManager::Get().Delete(*TempPath);
+		return;
+	}
+
+	UE_LOG(LogTemp, Warning, TEXT("Region file %s was missing after an interrupted save, so it was recovered from %s"), *Path, *TempPath);
+	if (!IFileManager::Get().Move(*Path, *TempPath))
+		UE_LOG(LogTemp, Error, TEXT("Failed to recover region file %s from %s"), *Path, *TempPath);
+}
+
+bool FRegionFile::ReadIndexFromData(const FString& Path, TConstArrayView<uint8> HeaderAndIndexData, int64 FileSize, TMap<FIntVector, FRegionFileRecord>& OutRecordsByCell)
+{
+	if (HeaderAndIndexData.Num() < HeaderSize)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Region file is too small to have a header: %s"), *Path);
+		return false;
+	}
+
+	uint32 Magic{};
+	uint32 Version{};
+	int32 RecordCount{};
+	FMemoryReaderView Reader(HeaderAndIndexData);
+	Reader << Magic << Version << RecordCount;
+
+	const int64 RecordsStart{ HeaderSize + RecordCount * IndexEntrySize };
+	if (Magic != FileMagic || Version != FileVersion || RecordCount < 0 || RecordsStart > FileSize || RecordsStart > HeaderAndIndexData.Num())
+	{
+		UE_LOG(LogTemp, Error, TEXT("Region file has an invalid header: %s"), *Path);
+		return false;
+	}
+
+	OutRecordsByCell.Reserve(RecordCount);
+	for (int32 RecordIndex{}; RecordIndex < RecordCount; RecordIndex++)
+	{
+		FIntVector Cell{};
+		FRegionFileRecord Record{};
+		Reader << Cell.X << Cell.Y << Cell.Z << Record.Offset << Record.Length;
+
+		if (Record.Offset < RecordsStart || Record.Length <= 0 || Record.Offset + Record.Length > FileSize)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Region file %s has an invalid record for cell %s"), *Path, *Cell.ToString());
+			OutRecordsByCell.Reset();
+			return false;
+		}
+		OutRecordsByCell.Add(Cell, Record);
+	}
+
+	return true;
+}
+
+bool FRegionFile::ReadRecordFromHandle(IFileHandle& FileHandle, const FRegionFileRecord& Record, TArray<uint8>& OutRecordData)
+{
+	OutRecordData.SetNumUninitialized(Record.Length);
+	if (!FileHandle.Seek(Record.Offset) || !FileHandle.Read(OutRecordData.GetData(), Record.Length))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to read the region file record at offset %lld"), Record.Offset);
+		OutRecordData.Reset();
+		return false;
+	}
+
+	return true;
+}
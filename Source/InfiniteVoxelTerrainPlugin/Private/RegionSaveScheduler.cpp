@@ -0,0 +1,153 @@
+// Copyright(c) 2024 Endless98. All Rights Reserved.
+
+#include "RegionSaveScheduler.h"
+#include "Async/Async.h"
+#include "HAL/PlatformProcess.h"
+
+FRegionSaveScheduler::FRegionSaveScheduler()
+{
+	IdleEvent = FPlatformProcess::GetSynchEventFromPool(true);
+	IdleEvent->Trigger();
+}
+
+FRegionSaveScheduler::~FRegionSaveScheduler()
+{
+	WaitForSaves();
+	{
+		FScopeLock Lock(&SchedulerMutex); // The last worker triggers IdleEvent while holding the lock, so wait for it to let go
+	}
+
+	FPlatformProcess::ReturnSynchEventToPool(IdleEvent);
+	IdleEvent = nullptr;
+}
+
+void FRegionSaveScheduler::Start(FSaveRegionFunction InSaveRegion)
+{
+	FScopeLock Lock(&SchedulerMutex);
+	SaveRegion = MoveTemp(InSaveRegion);
+	bIsAcceptingRequests = true;
+}
+
+void FRegionSaveScheduler::Stop()
+{
+	{
+		FScopeLock Lock(&SchedulerMutex);
+		bIsAcceptingRequests = false;
+	}
+
+	WaitForSaves();
+
+	FScopeLock Lock(&SchedulerMutex);
+	SaveRegion = nullptr;
+}
+
+void FRegionSaveScheduler::RequestSave(const FIntPoint& Region, bool bRemoveDataWhenDone)
+{
+	FScopeLock Lock(&SchedulerMutex);
+	if (!bIsAcceptingRequests)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Region %s was not saved because saving has stopped"), *Region.ToString());
+		return;
+	}
+
+	QueuedRegions.AddUnique(Region);
+	if (bRemoveDataWhenDone)
+		RegionsToRemoveWhenDone.Add(Region);
+
+	if (ActiveWorkers >= MaxConcurrentSaves || ActiveWorkers >= QueuedRegions.Num())
+		return; // The running workers will get to it
+
+	if (ActiveWorkers == 0)
+		IdleEvent->Reset();
+	ActiveWorkers++;
+
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [this]()
+		{
+			RunWorker();
+		});
+}
+
+void FRegionSaveScheduler::WaitForSaves()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FRegionSaveScheduler::WaitForSaves);
+
+	IdleEvent->Wait();
+}
+
+void FRegionSaveScheduler::WaitForRegion(const FIntPoint& Region)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FRegionSaveScheduler::WaitForRegion);
+
+	FEvent* RegionSavedEvent{};
+	{
+		FScopeLock Lock(&SchedulerMutex);
+		if (!IsSaveRequested(Region))
+			return;
+
+		RegionSavedEvent = FPlatformProcess::GetSynchEventFromPool(true);
+		RegionSavedEvents.Add(Region, RegionSavedEvent);
+	}
+
+	RegionSavedEvent->Wait();
+	{
+		FScopeLock Lock(&SchedulerMutex); // The worker triggers RegionSavedEvent while holding the lock, so wait for it to let go
+	}
+
+	FPlatformProcess::ReturnSynchEventToPool(RegionSavedEvent);
+}
+
+void FRegionSaveScheduler::TakeFailedRegions(TArray<FIntPoint>& OutRegions)
+{
+	FScopeLock Lock(&SchedulerMutex);
+	OutRegions.Append(FailedRegions);
+	FailedRegions.Reset();
+}
+
+void FRegionSaveScheduler::RunWorker()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FRegionSaveScheduler::RunWorker);
+
+	while (true)
+	{
+		FIntPoint Region{};
+		bool bRemoveDataWhenDone{};
+		{
+			FScopeLock Lock(&SchedulerMutex);
+			const int32 QueueIndex{ QueuedRegions.IndexOfByPredicate([this](const FIntPoint& QueuedRegion) { return !RegionsBeingSaved.Contains(QueuedRegion); }) };
+			if (QueueIndex == INDEX_NONE) // Anything left is being saved by another worker, which takes it again once it's done
+			{
+				ActiveWorkers--;
+				if (ActiveWorkers == 0)
+					IdleEvent->Trigger();
+
+				return;
+			}
+
+			Region = QueuedRegions[QueueIndex];
+			QueuedRegions.RemoveAt(QueueIndex);
+			bRemoveDataWhenDone = RegionsToRemoveWhenDone.Remove(Region) > 0;
+			RegionsBeingSaved.Add(Region);
+		}
+
+		const bool bSaved{ SaveRegion(Region, bRemoveDataWhenDone) };
+
+		FScopeLock Lock(&SchedulerMutex);
+		RegionsBeingSaved.Remove(Region);
+		if (!bSaved)
+			FailedRegions.AddUnique(Region);
+
+		if (!IsSaveRequested(Region)) // Otherwise whoever is waiting keeps waiting for the save requested while we worked
+		{
+			TArray<FEvent*> EventsToTrigger{};
+			RegionSavedEvents.MultiFind(Region, EventsToTrigger);
+			RegionSavedEvents.Remove(Region);
+			for (FEvent* RegionSavedEvent : EventsToTrigger)
+				RegionSavedEvent->Trigger();
+		}
+	}
+}
+
+bool FRegionSaveScheduler::IsSaveRequested(const FIntPoint& Region) const
+{
+	return QueuedRegions.Contains(Region) || RegionsBeingSaved.Contains(Region);
+}
@@ -0,0 +1,272 @@
+// Copyright(c) 2024 Endless98. All Rights Reserved.
+
+#include "VoxelCodec.h"
+#include "Misc/Compression.h"
+
+void FVoxelCodec::Encode(TConstArrayView<uint8> Voxels, TArray<uint8>& OutEncodedData, bool bFast)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FVoxelCodec::Encode);
+
+	OutEncodedData.Reset();
+	OutEncodedData.Add(static_cast<uint8>(EVoxelCodec::Raw));
+	EncodePayload(EVoxelCodec::Raw, Voxels, OutEncodedData);
+
+	TArray<uint8> CandidateData{};
+	auto TryCodec = [&Voxels, &OutEncodedData, &CandidateData](EVoxelCodec Codec)
+		{
+			CandidateData.Reset();
+			CandidateData.Add(static_cast<uint8>(Codec));
+			if (EncodePayload(Codec, Voxels, CandidateData) && CandidateData.Num() < OutEncodedData.Num())
+				Swap(OutEncodedData, CandidateData);
+		};
+
+	TryCodec(EVoxelCodec::VarintRunLength);
+	if (!bFast)
+		TryCodec(EVoxelCodec::RunLength); // Only wins when most runs are between 128 and 255 voxels long
+	if (OutEncodedData.Num() < MinSizeForGeneralCodecs)
+		return;
+
+	TryCodec(EVoxelCodec::LZ4);
+	if (bFast)
+		return;
+
+	TryCodec(EVoxelCodec::Oodle);
+	TryCodec(EVoxelCodec::Zlib);
+}
+
+bool FVoxelCodec::Decode(TConstArrayView<uint8> EncodedData, TArray<uint8>& OutVoxels)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FVoxelCodec::Decode);
+
+	OutVoxels.Reset();
+	if (EncodedData.IsEmpty())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Input data was empty. No Voxels to decode"));
+		return false;
+	}
+
+	const uint8 CodecByte{ EncodedData[0] };
+	if (CodecByte > static_cast<uint8>(EVoxelCodec::Oodle))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Encoded voxels use unknown codec %i"), CodecByte);
+		return false;
+	}
+
+	if (!DecodePayload(static_cast<EVoxelCodec>(CodecByte), EncodedData.Slice(1, EncodedData.Num() - 1), OutVoxels))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to decode voxels encoded with codec %i"), CodecByte);
+		OutVoxels.Reset();
+		return false;
+	}
+
+	return true;
+}
+
+bool FVoxelCodec::EncodePayload(EVoxelCodec Codec, TConstArrayView<uint8> Voxels, TArray<uint8>& OutEncodedData)
+{
+	switch (Codec)
+	{
+	case EVoxelCodec::Raw:
+		OutEncodedData.Append(Voxels.GetData(), Voxels.Num());
+		return true;
+
+	case EVoxelCodec::RunLength:
+		RunLengthEncode(Voxels, OutEncodedData);
+		return true;
+
+	case EVoxelCodec::VarintRunLength:
+		for (int32 RunStart{}; RunStart < Voxels.Num();)
+		{
+			int32 RunEnd{ RunStart + 1 };
+			while (RunEnd < Voxels.Num() && Voxels[RunEnd] == Voxels[RunStart])
+				RunEnd++;
+
+			WriteVarint(OutEncodedData, RunEnd - RunStart);
+			OutEncodedData.Add(Voxels[RunStart]);
+			RunStart = RunEnd;
+		}
+		return true;
+
+	default:
+		break;
+	}
+
+	const FName CompressionFormat{ GetCompressionFormat(Codec) };
+	if (CompressionFormat.IsNone() || !FCompression::IsFormatValid(CompressionFormat))
+		return false;
+
+	WriteVarint(OutEncodedData, Voxels.Num()); // The general purpose codecs need the decoded size up front
+	const int32 CompressedStart{ OutEncodedData.Num() };
+	int32 CompressedSize{ FCompression::CompressMemoryBound(CompressionFormat, Voxels.Num()) };
+	OutEncodedData.AddUninitialized(CompressedSize);
+	if (!FCompression::CompressMemory(CompressionFormat, OutEncodedData.GetData() + CompressedStart, CompressedSize, Voxels.GetData(), Voxels.Num()))
+		return false;
+
+	OutEncodedData.SetNum(CompressedStart + CompressedSize, EAllowShrinking::No);
+	return true;
+}
+
+bool FVoxelCodec::DecodePayload(EVoxelCodec Codec, TConstArrayView<uint8> Payload, TArray<uint8>& OutVoxels)
+{
+	switch (Codec)
+	{
+	case EVoxelCodec::Raw:
+		OutVoxels.Append(Payload.GetData(), Payload.Num());
+		return true;
+
+	case EVoxelCodec::RunLength:
+		RunLengthDecode(Payload, OutVoxels);
+		return true;
+
+	case EVoxelCodec::VarintRunLength:
+		for (int32 PayloadIndex{}; PayloadIndex < Payload.Num();)
+		{
+			uint32 RunLength{};
+			if (!ReadVarint(Payload, PayloadIndex, RunLength) || PayloadIndex >= Payload.Num() || RunLength > static_cast<uint32>(MaxDecodedSize - OutVoxels.Num()))
+				return false;
+
+			const int32 RunStart{ OutVoxels.Num() };
+			OutVoxels.AddUninitialized(RunLength);
+			FMemory::Memset(OutVoxels.GetData() + RunStart, Payload[PayloadIndex++], RunLength);
+		}
+		return true;
+
+	default:
+		break;
+	}
+
+	const FName CompressionFormat{ GetCompressionFormat(Codec) };
+	if (CompressionFormat.IsNone() || !FCompression::IsFormatValid(CompressionFormat))
+		return false;
+
+	int32 PayloadIndex{};
+	uint32 DecodedSize{};
+	if (!ReadVarint(Payload, PayloadIndex, DecodedSize) || DecodedSize > static_cast<uint32>(MaxDecodedSize))
+		return false;
+
+	OutVoxels.SetNumUninitialized(DecodedSize);
+	return FCompression::UncompressMemory(CompressionFormat, OutVoxels.GetData(), DecodedSize, Payload.GetData() + PayloadIndex, Payload.Num() - PayloadIndex);
+}
+
+FName FVoxelCodec::GetCompressionFormat(EVoxelCodec Codec)
+{
+	switch (Codec)
+	{
+	case EVoxelCodec::LZ4:
+		return NAME_LZ4;
+	case EVoxelCodec::Zlib:
+		return NAME_Zlib;
+	case EVoxelCodec::Oodle:
+		return NAME_Oodle;
+	default:
+		return NAME_None;
+	}
+}
+
+void FVoxelCodec::WriteVarint(TArray<uint8>& OutData, uint32 Value)
+{
+	while (Value >= 0x80) // Seven bits per byte, with the high bit set on every byte but the last
+	{
+		OutData.Add(static_cast<uint8>(Value | 0x80));
+		Value >>= 7;
+	}
+	OutData.Add(static_cast<uint8>(Value));
+}
+
+bool FVoxelCodec::ReadVarint(TConstArrayView<uint8> Data, int32& InOutIndex, uint32& OutValue)
+{
+	OutValue = 0;
+	for (int32 Shift{}; Shift < 35 && InOutIndex < Data.Num(); Shift += 7)
+	{
+		const uint8 Byte{ Data[InOutIndex++] };
+		OutValue |= static_cast<uint32>(Byte & 0x7F) << Shift;
+		if ((Byte & 0x80) == 0)
+			return true;
+	}
+
+	return false; // Ran off the end of the data, or the varint was too long to be a uint32
+}
+
+void RunLengthEncode(TArray<uint8>& VoxelData, FIntVector OwningChunkCell)
+{
+	if (VoxelData.IsEmpty())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Input data was empty. No Voxels to RunLengthEncode"));
+		return;
+	}
+
+	TArray<uint8> EncodedData;
+	RunLengthEncode(VoxelData, EncodedData);
+	VoxelData = MoveTemp(EncodedData);
+}
+
+void RunLengthEncode(TConstArrayView<uint8> Voxels, TArray<uint8>& OutEncodedData)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(RunLengthEncode);
+
+	if (Voxels.IsEmpty())
+		return;
+
+	OutEncodedData.Reserve(OutEncodedData.Num() + Voxels.Num() / 2);
+
+	int32 CurrentCount{ 1 };
+	uint8 CurrentValue{ Voxels[0] };
+
+	for (int32 VoxelIndex{ 1 }; VoxelIndex < Voxels.Num(); ++VoxelIndex)
+	{
+		if (Voxels[VoxelIndex] == CurrentValue && CurrentCount < MAX_uint8)
+			++CurrentCount;
+		else
+		{
+			OutEncodedData.Add(CurrentCount);
+			OutEncodedData.Add(CurrentValue);
+			CurrentCount = 1;
+			CurrentValue = Voxels[VoxelIndex];
+		}
+	}
+
+	OutEncodedData.Add(CurrentCount);
+	OutEncodedData.Add(CurrentValue);
+}
+
+void RunLengthDecode(TArray<uint8>& EncodedData, FIntVector OwningChunkCell)
+{
+	if (EncodedData.IsEmpty())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Input data was empty. No Voxels to RunLengthDecode"));
+		return;
+	}
+
+	TArray<uint8> DecodedData{};
+	RunLengthDecode(EncodedData, DecodedData);
+	EncodedData = MoveTemp(DecodedData);
+}
+
+void RunLengthDecode(TConstArrayView<uint8> EncodedData, TArray<uint8>& OutDecodedData)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(RunLengthDecode);
+
+	OutDecodedData.Reset();
+	if (EncodedData.IsEmpty())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Input data was empty. No Voxels to RunLengthDecode"));
+		return;
+	}
+
+	const int32 PairCount{ EncodedData.Num() / 2 }; // An odd trailing byte can only come from a damaged file, so it's ignored
+	int32 DecodedSize{ 0 };
+	for (int32 PairIndex{ 0 }; PairIndex < PairCount; PairIndex++)
+		DecodedSize += EncodedData[PairIndex * 2];
+
+	OutDecodedData.SetNumUninitialized(DecodedSize);
+
+	int32 DecodedIndex{ 0 };
+	for (int32 PairIndex{ 0 }; PairIndex < PairCount; PairIndex++)
+	{
+		uint8 Count{ EncodedData[PairIndex * 2] };
+		uint8 Value{ EncodedData[PairIndex * 2 + 1] };
+
+		FMemory::Memset(OutDecodedData.GetData() + DecodedIndex, Value, Count);
+		DecodedIndex += Count;
+	}
+}
@@ -8,8 +8,14 @@
 #include "RealtimeMeshSimple.h"
 #include "Interface/Core/RealtimeMeshDataStream.h"
 #include "Materials/Material.h"
+#include "PaletteVoxelStorage.h"
 #include "ChunkActor.generated.h"
 
+// Chunks are meshed in vertical slabs, each in its own section group, so an edit only rebuilds and uploads the slabs it touches
+constexpr int32 ChunkSlabHeightInVoxels{ 8 };
+constexpr uint32 AllChunkSlabs{ MAX_uint32 }; // Slab mask with every slab set
+inline int32 GetChunkSlabCount(const int32 VoxelCount) { return FMath::DivideAndRoundUp(VoxelCount, ChunkSlabHeightInVoxels); }
+
 struct FChunkMeshData
 {
 
@@ -20,6 +26,7 @@ public:
     TArray<uint8> VoxelSections{};
     bool bShouldGenCollision{};
     bool bIsMeshEmpty{};
+    int32 SlabIndex{};
 
     FChunkMeshData()
         : CollisionType(ECollisionResponse::ECR_Block)
@@ -40,7 +47,8 @@ public:
         ChunkCell(MoveTemp(Other.ChunkCell)),
         VoxelSections(MoveTemp(Other.VoxelSections)),
         bShouldGenCollision(MoveTemp(Other.bShouldGenCollision)),
-        bIsMeshEmpty(MoveTemp(Other.bIsMeshEmpty))
+        bIsMeshEmpty(MoveTemp(Other.bIsMeshEmpty)),
+        SlabIndex(Other.SlabIndex)
     { }
 
     // Move assignment operator
@@ -54,6 +62,7 @@ public:
             VoxelSections = MoveTemp(Other.VoxelSections);
             bShouldGenCollision = MoveTemp(Other.bShouldGenCollision);
             bIsMeshEmpty = MoveTemp(Other.bIsMeshEmpty);
+            SlabIndex = Other.SlabIndex;
         }
         return *this;
     }
@@ -63,6 +72,14 @@ public:
     FChunkMeshData& operator=(const FChunkMeshData& Other) = delete;
 };
 
+struct FChunkSlabSections
+{
+    TArray<FRealtimeMeshSectionKey> SectionKeys{};
+    TArray<uint8> VoxelSections{}; // The voxel value of each section, which is also its material slot
+    bool bHasSectionGroup{};
+    uint32 MeshRevision{}; // Bumped every time a background remesh of this slab starts, so stale results can be dropped
+};
+
 UCLASS()
 class INFINITEVOXELTERRAINPLUGIN_API AChunkActor : public ARealtimeMeshActor
 {
@@ -88,9 +105,7 @@ public:
 protected:
 
     FIntVector ChunkCell{};
-    // Voxels are sometimes passed to the Chunk actor in a compressed state but will be decompressed when the chunk needs to be modified
-    TArray<uint8> Voxels;
-    bool bAreVoxelsCompressed{};
+    FPaletteVoxelStorage Voxels; // Packed by the ChunkThread before spawning. Can be read and written without unpacking
 
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voxel")
     float VoxelSize;
@@ -109,11 +124,20 @@ private:
     // if this is false it means destroy was called from the server (or Destroy was called somewhere outside of DestroyOrHideChunk)
 	bool bIsClientAttemptingToDestroyChunk{ false };
 	bool bShouldDestroyWhenUnneeded{ false };
+    bool bHasReplicatedName{ false }; // Set once the chunk is renamed to its deterministic replicated name. These chunks are never pooled, since the name can't be reused for another cell
 
     URealtimeMeshSimple* RealtimeMesh;
-    TArray<FRealtimeMeshSectionKey> MeshSectionKeys{};
+    TArray<FChunkSlabSections> SlabSections{}; // Indexed by slab
     
     void GenerateChunkCollision();
-    void GenerateChunkMesh(FChunkMeshData& ChunkMeshData, TArray<UMaterial*>& VoxelMaterials);
+    void GenerateChunkMesh(FChunkMeshData& ChunkMeshData, TArray<UMaterial*>& VoxelMaterials); // Replaces the mesh of the slab ChunkMeshData was generated for
+    void RemoveSlabSectionGroup(const int32 SlabIndex);
+    bool HasAnyMeshSections() const;
+    uint32 StartSlabRemesh(const int32 SlabIndex);
+    bool IsSlabRemeshCurrent(const int32 SlabIndex, const uint32 MeshRevision) const;
     void SetCollisionType(ECollisionEnabled::Type CollisionType);
+
+    // === Pooling ===
+    void ResetForPool(); // Clears the mesh, voxels and flags, and hides the chunk so it can be reused for another cell
+    void ActivateFromPool(const FVector& NewLocation); // Stands in for FinishSpawning when a pooled chunk is reused
 };
\ No newline at end of file
@@ -0,0 +1,66 @@
+// Copyright(c) 2024 Endless98. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Event.h"
+#include "HAL/ThreadSafeBool.h"
+#include "Templates/Function.h"
+
+struct FChunkJob
+{
+	FIntPoint HeightmapCell{};
+	float Priority{}; // Jobs with lower values are generated first
+
+	FChunkJob() {}
+
+	FChunkJob(const FIntPoint& InHeightmapCell, float InPriority)
+		: HeightmapCell(InHeightmapCell), Priority(InPriority) {}
+
+	friend bool operator<(const FChunkJob& LHS, const FChunkJob& RHS)
+	{
+		return LHS.Priority < RHS.Priority;
+	}
+};
+
+// Shared by a claimed heightmap job and every chunk it produces. The first ChunkThread cancels it once the location goes out of range, and each stage of generation checks it before doing more work
+struct FChunkJobToken
+{
+	FIntPoint HeightmapCell{};
+	FThreadSafeBool bIsCancelled{ false };
+
+	explicit FChunkJobToken(const FIntPoint& InHeightmapCell)
+		: HeightmapCell(InHeightmapCell) {}
+};
+using FChunkJobTokenPtr = TSharedPtr<FChunkJobToken, ESPMode::ThreadSafe>;
+
+// Shared by all ChunkThreads. The first ChunkThread refills it when the tracked locations or generation radius change, and every ChunkThread takes jobs from it
+// ChunkThreads register an event here and sleep on it while there is nothing to do
+class INFINITEVOXELTERRAINPLUGIN_API FChunkJobQueue
+{
+public:
+	void ReplaceJobs(TArray<FChunkJob>& NewJobs); // Drops all queued and deferred jobs
+	void Push(const FChunkJob& Job);
+	bool Dequeue(FChunkJob& OutJob); // Returns false if there are no jobs
+	void Defer(const FChunkJob& Job, uint32 ReleaseCountBeforeCheck); // Holds the job until ReleaseDeferredJobs is called. Pass in GetReleaseCount from before you checked if the job could run
+	void ReleaseDeferredJobs(); // Call this when something deferred jobs are waiting on is ready, such as region data
+	uint32 GetReleaseCount() const;
+	int32 Num() const;
+
+	void AddWorkerEvent(FEvent* WorkerEvent);
+	void RemoveWorkerEvent(FEvent* WorkerEvent);
+	void WakeWorkers(); // Wakes every ChunkThread even if there are no jobs, so they can pick up new tracked locations
+
+	FChunkJobTokenPtr StartJob(const FIntPoint& HeightmapCell); // Call once a job is claimed. The token is tracked until nothing references it anymore
+	void CancelJobs(TFunctionRef<bool(const FIntPoint& HeightmapCell)> ShouldCancel); // Cancels every job still in flight that ShouldCancel returns true for
+
+private:
+	void TriggerWorkerEvents(); // Lock the QueueMutex before calling
+
+	mutable FCriticalSection QueueMutex{};
+	TArray<FChunkJob> Jobs{};         // Kept as a heap so the lowest priority value is always first // Lock the QueueMutex before accessing
+	TArray<FChunkJob> DeferredJobs{}; // Lock the QueueMutex before accessing
+	TArray<FEvent*> WorkerEvents{};   // Lock the QueueMutex before accessing
+	uint32 ReleaseCount{};            // Lock the QueueMutex before accessing
+	TArray<TWeakPtr<FChunkJobToken, ESPMode::ThreadSafe>> InFlightJobs{}; // Lock the QueueMutex before accessing
+};
@@ -4,6 +4,12 @@
 
 #include "CoreMinimal.h"
 #include "ChunkActor.h"
+#include "ChunkJobQueue.h"
+#include "EditJournal.h"
+#include "ModifiedChunkVoxels.h"
+#include "RegionFile.h"
+#include "RegionSaveScheduler.h"
+#include "ShardedCellMap.h"
 #include "VoxelTypesDatabase.h"
 #include "Engine/NetDriver.h"
 #include "TimerManager.h"
@@ -55,8 +61,9 @@ public:
 	FIntVector Cell{};
 	bool bShouldGenerateCollision{};
 	TArray<uint8> Voxels{};
-	bool bAreVoxelsCompressed{};
-	FChunkMeshData MeshData{};
+	FPaletteVoxelStorage PackedVoxels{}; // Filled from Voxels once the mesh data is generated, and handed to the chunk actor
+	TArray<FChunkMeshData> SlabMeshData{};
+	FChunkJobTokenPtr JobToken{}; // Shared by every chunk in the column
 
 	FChunkConstructionData() = default;
 
@@ -71,8 +78,9 @@ public:
 		, Cell(MoveTemp(Other.Cell))
 		, bShouldGenerateCollision(MoveTemp(Other.bShouldGenerateCollision))
 		, Voxels(MoveTemp(Other.Voxels))
-		, bAreVoxelsCompressed(MoveTemp(Other.bAreVoxelsCompressed))
-		, MeshData(MoveTemp(Other.MeshData))
+		, PackedVoxels(MoveTemp(Other.PackedVoxels))
+		, SlabMeshData(MoveTemp(Other.SlabMeshData))
+		, JobToken(MoveTemp(Other.JobToken))
 	{
 		// Reset or clear Other's members to release ownership of resources
 		Other.Cell = FIntVector{};
@@ -88,8 +96,9 @@ public:
 			Cell = MoveTemp(Other.Cell);
 			bShouldGenerateCollision = MoveTemp(Other.bShouldGenerateCollision);
 			Voxels = MoveTemp(Other.Voxels);
-			bAreVoxelsCompressed = MoveTemp(Other.bAreVoxelsCompressed);
-			MeshData = MoveTemp(Other.MeshData);
+			PackedVoxels = MoveTemp(Other.PackedVoxels);
+			SlabMeshData = MoveTemp(Other.SlabMeshData);
+			JobToken = MoveTemp(Other.JobToken);
 
 			// Reset or clear Other's members to release ownership of resources
 			Other.Cell = FIntVector{};
@@ -99,6 +108,8 @@ public:
 		return *this;
 	}
 
+	bool IsCancelled() const { return JobToken.IsValid() && JobToken->bIsCancelled; }
+
 	bool operator==(const FChunkConstructionData& Other) const
 	{	return Cell == Other.Cell; }
 
@@ -279,7 +290,7 @@ struct FTerrainSettings
 	int32 CollisionGenerationRadius{ 5 };
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Terrain Settings")
 	float VoxelSize{ 100.0 };
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Terrain Settings")
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Terrain Settings", meta = (ClampMin = "1", ClampMax = "62")) // Limited by the uint64 face masks used for meshing
 	int32 VoxelCount{ 32 };
 
 	FTerrainSettings() = default;
@@ -304,6 +315,42 @@ struct FTerrainSettings
 	}
 };
 
+UENUM(BlueprintType)
+enum class EVoxelEditShape : uint8
+{
+	Box UMETA(DisplayName = "Box"),
+	Sphere UMETA(DisplayName = "Sphere"),
+	Line UMETA(DisplayName = "Line")
+};
+
+// One edit covering many voxels. Small enough to replicate as a single RPC no matter how many voxels it touches
+USTRUCT(BlueprintType)
+struct FVoxelShapeEdit
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Set Voxel")
+	EVoxelEditShape Shape{ EVoxelEditShape::Sphere };
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Set Voxel")
+	FVector_NetQuantize Center{}; // The start point for lines
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Set Voxel")
+	FVector_NetQuantize End{}; // Only used by lines
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Set Voxel")
+	FVector_NetQuantize Extent{}; // Half size of boxes
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Set Voxel")
+	float Radius{}; // Radius of spheres, and the thickness of lines
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Set Voxel")
+	uint8 VoxelValue{};
+};
+
+// Voxel changes to a single chunk, gathered so the chunk is only locked, saved and remeshed once per edit
+struct FChunkVoxelEdits
+{
+	TArray<int32> VoxelIndices{};
+	TArray<uint8> VoxelValues{};
+	uint32 DirtySlabs{};
+};
+
 class FChunkThread;
 class FChunkThreadChild;
 struct FChunkNameData;
@@ -345,6 +392,7 @@ private:
 	void UpateNearbyChunkCollisions();
 	void HandleClientNeededServerData();
 	void DequeueAndDestroyChunks();
+	void SpawnQueuedChunks(bool bDidTrackedLocationsChange);
 	void UpdateRegionsAsync(bool bForUpdate = false);
 
 	// == EndPlay Functions ===
@@ -371,9 +419,9 @@ private:
 	void AddToRegionsThatHaveData(FIntPoint Region);
 
 	// === Chunk Replication Functions ===
-	void ReplicateChunkNamesAsync(const FVector2D& PlayerLocation);
+	void ReplicateChunkNamesAsync(const FIntPoint& PlayerCell2D);
 	void ReplicateChunkNames(FIntVector CenterCell, bool bEnsureNoneMissing = false); // Do not call from game thread
-	void GetAllChunkCellsInRadius(int32 SearchRadius, const FVector2D& TrackedLocation, TArray<FIntVector>& OutFoundChunkCells, TArray<FIntPoint>& OutMissing2DCells);
+	void GetAllChunkCellsInRadius(int32 SearchRadius, const FIntPoint& CenterCell2D, TArray<FIntVector>& OutFoundChunkCells, TArray<FIntPoint>& OutMissing2DCells);
 	void SetChunkName(AChunkActor* Chunk, const FIntVector& ChunkRepCell, const int32& ChunkRepCount);
 	void UnreplicateChunk(FIntVector ChunkCell);
 	void SendChunkNameDataToClients(FChunkNameData& ChunkNameData);
@@ -383,14 +431,27 @@ private:
 	// === Functions used by SetVoxel ===
 	void SetBorderVoxels(FIntVector& VoxelIntPosition, const FVector& VoxelWorldLocation, int32 VoxelValue, const FIntVector& ChunkCell);
 	void GetMaterialsForChunkData(TArray<uint8> VoxelSections, TArray<UMaterial*>& VoxelMaterials);
-	void UpdateChunkMesh(AChunkActor* Chunk);
+	void MarkChunkSlabsDirty(const FIntVector& ChunkCell, const uint32 Slabs);
+	void RemeshDirtyChunks();
+	void RemeshChunkAsync(AChunkActor* Chunk, const uint32 SlabsToMesh);
+	void ApplySlabMeshData(AChunkActor* Chunk, TArray<FChunkMeshData>& SlabMeshData);
+	uint32 GetSlabsTouchingVoxel(const int32 VoxelZ) const; // The slab holding the voxel, plus any slab holding a voxel it shares a face with
 	void UpdateModifiedVoxels(const FIntVector& ChunkCell, int32 VoxelIndex, int32 VoxelValue);
+	void UpdateModifiedVoxels(const FIntVector& ChunkCell, const TArray<int32>& VoxelIndices, const TArray<uint8>& VoxelValues);
+	void SetModifiedVoxels(const FIntVector& ChunkCell, const TArray<int32>& VoxelIndices, const TArray<uint8>& VoxelValues); // Only changes the voxels kept for saving. Don't hold the ModifiedVoxelsMutex when calling
+	bool GetVoxelLocationsInShape(const FVoxelShapeEdit& ShapeEdit, TArray<FVector>& OutVoxelLocations) const; // Returns false if the shape covers too many voxels
+	void AddVoxelEdit(TMap<FIntVector, FChunkVoxelEdits>& EditsByChunkCell, const FIntVector& ChunkCell, const FVector& VoxelWorldLocation, uint8 VoxelValue, FIntVector& OutVoxelIntPosition);
+	void ApplyVoxelEditsToChunk(const FIntVector& ChunkCell, const FChunkVoxelEdits& ChunkVoxelEdits);
+	bool HasModifiedVoxels(const FIntVector& ChunkCell);
+	bool ReadUnreadChunkRecord(const FIntVector& ChunkCell); // Decodes the chunk's record from its region file if nobody has yet. Returns false if there was nothing to read. Don't hold the ModifiedVoxelsMutex when calling
+	void ReadUnreadRecordsForRegion(const FIntPoint& Region, TMap<FIntVector, TArray<uint8>>& OutRecordDataByCell); // Copies out the still encoded records nobody has read yet. Don't hold the ModifiedVoxelsMutex when calling
+	bool FindUnreadChunkRecord(const FIntPoint& Region, const FIntVector& ChunkCell, FString& OutPath, FRegionFileRecord& OutRecord);
 	void CheckForNeededNeighborChunks(FVector VoxelLocation, TArray<FIntVector>& OutNeededChunkCells);
 	int32 GetVoxelIndex(FVector ChunkLocation, const FVector& VoxelWorldLocation, FIntVector& OutVoxelIntPosition);
 	void SpawnAdditionalVerticalChunk(FVector VoxelWorldLocation, int32 VoxelValue, const FIntVector ChunkCell);
 
 	// === Chunk Hiding and Destroying ===
-	void DestroyChunksAtHeightmapLocation(const FVector2D& HeightmapLocation, const TArray<int32> ChunkZIndices);
+	void DestroyChunksAtHeightmapCell(const FIntPoint& HeightmapCell, const TArray<int32> ChunkZIndices);
 	void DestroyOrHideChunk(FIntVector ChunkCell, bool& OutbWasHidden);
 	void DestroyOrHideChunk(AChunkActor* Chunk, bool& OutbWasHidden);
 	void DestroyChunk(FIntVector& ChunkCell);
@@ -398,7 +459,7 @@ private:
 	bool HideChunk(AChunkActor* Chunk);
 	bool UnhideChunk(AChunkActor* Chunk);
 	bool UnhideChunk(FIntVector ChunkCell);
-	void UnhideChunksInHeightmapLocations(TArray<FVector2D>* HeightmapLocations);
+	void UnhideChunksInHeightmapCells(TArray<FIntPoint>* HeightmapCells);
 
 public:
 
@@ -412,6 +473,8 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Set Voxel")
 	virtual void SetVoxel(FVector VoxelLocation, int32 VoxelValue, const FIntVector ChunkCell, bool bSetVoxelInAdjacentChunk = true, bool bCheckForMissingAdjacentChunks = true);
 	UFUNCTION(BlueprintCallable, Category = "Set Voxel")
+	virtual void SetVoxelsInShape(const FVoxelShapeEdit& ShapeEdit); // Only changes this machine's voxels. Use UChunkModifierComponent::SetVoxelsInShape to replicate the edit
+	UFUNCTION(BlueprintCallable, Category = "Set Voxel")
 	const int32 GetVoxel(FVector VoxelLocation, FIntVector ChunkCell);
 	UFUNCTION(BlueprintCallable, Category = "World Save")
 	void SetSaveGameName(const FString& NewWorldSaveName);
@@ -421,7 +484,7 @@ protected:
 	void SetVoxelMulticast(FVector VoxelLocation, int32 VoxelValue, const FIntVector ChunkCell); // Called from ChunkModifierComponent's server function
 	
 	UFUNCTION(NetMulticast, Reliable, Category = "Replication")
-	void ReplicatePlayerChunkLocations(const TArray<FVector2D>& PlayerHeightmapCells); // Used to let the clients know which chunks are safe to destroy
+	void ReplicatePlayerChunkLocations(const TArray<FIntPoint>& PlayerHeightmapCells); // Used to let the clients know which chunks are safe to destroy
 
 private:
 
@@ -452,42 +515,69 @@ private:
 	float AutosaveInterval{60.f};
 	const float RegionBundleSendInterval{ 2.f };
 	const int32 MaxRegionDataSendSizeInBytes{ 60000 };
+	const int32 MaxVoxelsPerShapeEdit{ 65536 };
 	const int32 RegionSizeInChunks{ 50 };
 	const int32 RegionBufferSize{ 1 };
+	UPROPERTY(EditAnywhere, Category = "Generation Settings")
+	bool bUseGreedyMeshing{ false }; // Merges coplanar faces into larger quads. Voxel materials need to tile their UVs
+	UPROPERTY(EditAnywhere, Category = "Generation Settings")
+	float ChunkSpawnBudgetMs{ 4.f }; // Game thread time per tick we can spend spawning chunks. At least one chunk is always spawned per tick
+	UPROPERTY(EditAnywhere, Category = "Generation Settings")
+	int32 MaxCachedHeightmaps{ 1024 }; // Heightmaps kept around so vertical chunks and reloaded columns don't regenerate noise. Each one is about (VoxelCount + 2)^2 * 2 bytes
 
 	// === ChunkThreads ===
 	TArray<FChunkThreadChild*> ChunkThreads{};
 	int32 TotalThreadsAvailable{ FPlatformMisc::NumberOfCoresIncludingHyperthreads() };
 	int32 NumThreadsToKeepFree{ 4 }; // Subtract this from TotalThreadsAvailable to get the number of threads we can use
-	float ThreadWorkingSleepTime{ 0.014 }; // Recommended Minimum Sleep Time: 0.01
-	float ThreadIdleSleepTime{ 0.03 }; // Recommended Minimum Sleep Time: 0.01
+	float ThreadCPUBudget{ 0.9 }; // The fraction of time each ChunkThread may spend generating while it has jobs. Lower this to leave more CPU for the game
+	FChunkJobQueue ChunkJobQueue{}; // Shared by all ChunkThreads
 
 	// === Player Tracking ===
 	APlayerController* LocalPlayerController{};
 	TArray<APlayerController*> TrackedPlayers;
-	TArray<FVector2D> PlayerLocations{};
+	TArray<FIntPoint> PlayerCells{}; // The 2D chunk cell each tracked player is in
+	TArray<FVector2D> PlayerViewDirections{}; // Normalized 2D camera direction. Zero for players that aren't local, since we don't know where they are looking
+	TArray<FVector2D> PlayerVelocities{};
+	TArray<FIntPoint> PredictedPlayerCells{}; // The 2D chunk cell each player will be in after PredictionSeconds at their current velocity
 	TArray<bool> TrackedHasFoundChunkInSpawnLocation{};
 	TMap<APlayerController*, TArray<FIntVector>> TrackedChunkNamesUpToDate{};
 	FRWLock ThreadPlayerLocationsLock{};
-	TArray<FVector2D> ThreadUseableLocations{}; // Lock the ThreadPlayerLocationsLock before accessing this
+	TArray<FIntPoint> ThreadUseablePlayerCells{}; // Lock the ThreadPlayerLocationsLock before accessing this
+	TArray<FVector2D> ThreadUseableViewDirections{}; // Lock the ThreadPlayerLocationsLock before accessing this
+	TArray<FVector2D> ThreadUseableVelocities{}; // Lock the ThreadPlayerLocationsLock before accessing this
+	TArray<FIntPoint> ThreadUseablePredictedCells{}; // Lock the ThreadPlayerLocationsLock before accessing this
+	bool bHasUnpublishedTrackedLocations{}; // Set until the ChunkThreads can see the latest tracked locations. Only access this from the Game Thread
+	UPROPERTY(EditAnywhere, Category = "Generation Settings")
+	float PredictionSeconds{ 3.f }; // How far ahead along each player's velocity we prefetch heightmaps. Capped at the ChunkGenerationRadius. 0 disables prefetching
+	UPROPERTY(EditAnywhere, Category = "Generation Settings")
+	float ViewPriorityWeight{ 1.5f }; // How much later heightmaps behind a local player's camera are generated. 0 ignores the view direction
+	UPROPERTY(EditAnywhere, Category = "Generation Settings")
+	float VelocityPriorityWeight{ 1.f }; // How much sooner heightmaps in the direction a player is moving are generated. 0 ignores movement
+	const float ViewDirectionRequeueDot{ 0.7f }; // Turning further than this from the last published view direction requeues the heightmap jobs
 
 	// === Chunk Tracking ===
 	TMap<FIntVector, AChunkActor*> ChunksByCell; // This one is important. It stores our references to the chunk actors. // Only access this from the Game Thread
 	TMap<FIntPoint, TArray<int32>> ChunkZIndicesBy2DCell; // Only access this from the Game Thread
-	FCriticalSection HeightmapMutex; // Lock this before accessing the HeightmapLocations
-	TSet<FVector2D> ExistingHeightmapLocations; // Only the ChunkThreads actually need this. It's how we know which chunks are already generated // Lock the HeightmapMutex before accessing this
+	TShardedCellMap<bool> ExistingHeightmapCells; // Only the ChunkThreads actually need this. It's how we know which chunks are already generated, and TryAdd is how a ChunkThread claims a heightmap. The value is unused
 	TMap<FIntVector, int32> ChunkSpawnCountByCell{}; // Used to generate a unique deterministic name for each chunk every time we replicate it
 	TArray<FString> NamesAlreadyUsed{};
 
 	// === Modified Voxels === 
+	// Lock order: RegionLoadMutex, then RegionFileMutex, then ModifiedVoxelsMutex. The RegionMutex is never held while taking any of them
 	FCriticalSection ModifiedVoxelsMutex{};
-	TMap<FIntPoint, TMap<FIntVector, TArray<uint8>>> ModifiedVoxelsByCellByRegion; 	// Lock the mutex before accessing
+	TMap<FIntPoint, TMap<FIntVector, FModifiedChunkVoxels>> ModifiedVoxelsByCellByRegion; 	// Lock the mutex before accessing
+	TMap<FIntPoint, FRegionFileState> RegionFilesByRegion{}; // Lock the ModifiedVoxelsMutex before accessing. A chunk with a record that isn't in ModifiedVoxelsByCellByRegion yet hasn't been read from disk
+	FCriticalSection RegionFileMutex{}; // Held while reading a region file or swapping in a newly written one. A save reads its own region without it, since nothing else replaces that file
+	FEditJournal EditJournal{}; // Opened by the first ChunkThread once it has replayed any edits a crash left behind
+	FRegionSaveScheduler RegionSaveScheduler{}; // Started by the first ChunkThread, which every region save goes through
 
 	// === Region Tracking ===
 	TMap<APlayerController*, TArray<FIntPoint>> TrackedRegionsByPlayer{};
 	FCriticalSection RegionMutex{};
 	TArray<FIntPoint> RegionsPendingLoad;          // Lock the RegionMutex before accessing
 	TArray<FIntPoint> RegionsAlreadyLoaded;        // Lock the RegionMutex before accessing
+	TArray<FIntPoint> RegionsBeingLoaded;          // Lock the RegionMutex before accessing
+	FCriticalSection RegionLoadMutex{};            // Held while a region is loaded, so a save can wait for a load in flight. Lock it before any other region mutex
 	TArray<FIntPoint> RegionsPendingSave;		   // Lock the RegionMutex before accessing
 	TArray<FIntPoint> RegionsChangedSinceLastSave; // Lock the RegionMutex before accessing
 	TMap<APlayerController*, TArray<FIntPoint>> TrackedRegionsPendingServerData; // Server uses these to track which clients need or have data. Client uses them to track locally. Nullptr if viewing on client
@@ -501,17 +591,36 @@ private:
 	TArray<FIntVector> ChunksToDestroyQueue{}; // Destroying AActors can get expensive, so we spread them out over multiple frames
 	const int32 ChunksToDestroyPerFrame{ 150 };
 
+	// === Chunk Remeshing ===
+	TMap<FIntVector, uint32> DirtySlabsByChunkCell{}; // Slabs edited since the last tick. Each chunk is remeshed once per tick no matter how many edits it got // Only access this from the Game Thread
+
+	// === Chunk Pooling ===
+	UPROPERTY()
+	TArray<AChunkActor*> PooledChunks{}; // Hidden chunks waiting to be reused for another cell // Only access this from the Game Thread
+	UPROPERTY(EditAnywhere, Category = "Generation Settings")
+	int32 MaxPooledChunkActors{ 512 }; // Chunks destroyed while the pool is full are destroyed normally
+	bool ReleaseChunkToPool(AChunkActor* Chunk);
+	AChunkActor* TakePooledChunk();
+
+	// === Chunk Spawning ===
+	FCriticalSection ChunkSpawnQueueMutex{};
+	TArray<TSharedPtr<FChunkConstructionData>> ChunkSpawnQueue{}; // Filled by the ChunkThreads // Lock the ChunkSpawnQueueMutex before accessing
+	TArray<TSharedPtr<FChunkConstructionData>> PendingChunkSpawns{}; // Game thread only. Sorted so the chunk closest to a player is last
+	void EnqueueChunksToSpawn(TArray<TSharedPtr<FChunkConstructionData>>& ChunkConstructionDataArray); // Safe to call from any thread. Empties the passed in array
+	void SortPendingChunkSpawns();
+
 	// === Utility Functions ===
 	bool GetDoesClientNeedRegionData(APlayerController* PlayerController, FIntPoint Region) { return !GetDoesClientHaveRegionData(PlayerController, Region) && GetIsClientPendingRegionData(PlayerController, Region); }
 	bool GetDoesClientHaveRegionData(APlayerController* PlayerController, FIntPoint Region) { return TrackedRegionsThatHaveServerData.Find(PlayerController) && TrackedRegionsThatHaveServerData.Find(PlayerController)->Contains(Region); }
 	bool GetIsClientPendingRegionData(APlayerController* PlayerController, FIntPoint Region) { return TrackedRegionsPendingServerData.Find(PlayerController) && TrackedRegionsPendingServerData.Find(PlayerController)->Contains(Region); }
-	bool IsChunkGeneratedInThis2DLocation(const FVector2D& PlayerLocation) { return ChunkZIndicesBy2DCell.Contains(Get2DCellFromChunkLocation2D(PlayerLocation, ChunkSize)); }
+	bool IsChunkGeneratedInThis2DCell(const FIntPoint& Cell2D) { return ChunkZIndicesBy2DCell.Contains(Cell2D); }
 	static FORCEINLINE FVector GetChunkGridLocation(FVector Location, float ChunkSize) { return FVector(FMath::GridSnap(Location.X, ChunkSize), FMath::GridSnap(Location.Y, ChunkSize), FMath::GridSnap(Location.Z, ChunkSize)); };
 	static FORCEINLINE FIntVector GetCellFromChunkLocation(FVector ChunkLocation, float ChunkSize) { return FIntVector(ChunkLocation.GridSnap(ChunkSize) / ChunkSize); }
 	static FORCEINLINE FIntPoint Get2DCellFromChunkLocation2D(FVector2D ChunkLocation, float ChunkSize) { return FIntPoint((FMath::GridSnap(ChunkLocation.X, ChunkSize) / ChunkSize), (FMath::GridSnap(ChunkLocation.Y, ChunkSize) / ChunkSize)); }
 	static FORCEINLINE FVector GetLocationFromChunkCell(FIntVector ChunkCell, float ChunkSize) { return FVector(ChunkCell) * ChunkSize; }
 	static FORCEINLINE FVector2D Get2DLocationFromChunkCell2D(FIntPoint ChunkCell2D, float ChunkSize) { return FVector2D(ChunkCell2D) * ChunkSize; }
-	static FORCEINLINE FIntPoint GetRegionByLocation(const FVector2D& CurrentLocation, float ChunkSize, int32 RegionSizeInChunks) { return FIntPoint(FMath::GridSnap(CurrentLocation.X, ChunkSize * RegionSizeInChunks) / (ChunkSize * RegionSizeInChunks), FMath::GridSnap(CurrentLocation.Y, ChunkSize * RegionSizeInChunks) / (ChunkSize * RegionSizeInChunks)); }
+	static FORCEINLINE FIntPoint Get2DCellFromLocation(const FVector& Location, float ChunkSize) { return FIntPoint(FMath::RoundToInt32(Location.X / ChunkSize), FMath::RoundToInt32(Location.Y / ChunkSize)); } // The chunk cell whose center is nearest, the same as snapping to the chunk grid
+	static FORCEINLINE FIntPoint GetRegionByCell(const FIntPoint& Cell2D, int32 RegionSizeInChunks) { return FIntPoint(FMath::FloorToInt32((Cell2D.X + RegionSizeInChunks * 0.5) / RegionSizeInChunks), FMath::FloorToInt32((Cell2D.Y + RegionSizeInChunks * 0.5) / RegionSizeInChunks)); } // Make sure this function matches the one in ChunkThread.h
 };
 
 inline bool GetVoxelOnBorder(FIntVector VoxelIntPosition, int32 VoxelCount, TArray<int32>& OutFaceDirectionIndices);
@@ -14,6 +14,7 @@
 class AChunkManager;
 struct FRegionData;
 struct FTerrainSettings;
+struct FVoxelShapeEdit;
 
 USTRUCT()
 struct FChunkNameData
@@ -85,6 +86,15 @@ public:
 	UFUNCTION(Client, Reliable, Category = "Set Voxel")
 	void FailedSetVoxel(FVector VoxelLocation, int32 PreviousVoxelValue);
 
+	UFUNCTION(BlueprintCallable, Category = "Set Voxel")
+	void SetVoxelsInShape(const FVoxelShapeEdit& ShapeEdit); // Sets every voxel in the shape, then replicates the whole edit as one RPC
+
+	UFUNCTION(Server, Reliable, Category = "Set Voxel")
+	void ServerSetVoxelsInShape(const FVoxelShapeEdit& ShapeEdit, UChunkModifierComponent* CallingComponent);
+
+	UFUNCTION(Client, Reliable, Category = "Set Voxel")
+	void ClientSetVoxelsInShape(const FVoxelShapeEdit& ShapeEdit);
+
 	UFUNCTION(Server, Reliable, Category = "Set Voxel")
 	void ServerReadyForReplication();
 
@@ -105,6 +115,7 @@ private:
 	bool AreThereAnyOverlappingPawns(const FVector& VoxelLocation, float VoxelSize);
 
 	void GetVoxelLocationFromHitLocation(FVector Normal, FVector HitLocation, bool bIsEmptyVoxel, AChunkActor* HitChunk, FVector& OutVoxelLocation);
+	void GetOtherChunkModifierComponents(UChunkModifierComponent* CallingComponent, TArray<UChunkModifierComponent*>& OutChunkModifierComponents);
 	bool bIsReadyForReplication{ false };
 
 	float ReachDistance{ 800 };
@@ -4,6 +4,9 @@
 
 #include "CoreMinimal.h"
 #include "VoxelTypesDatabase.h"
+#include "ChunkJobQueue.h"
+#include "ShardedCellMap.h"
+#include "VoxelCodec.h"
 #include "Engine/World.h"
 #include "FastNoise/FastNoise.h"
 #include "HAL/Runnable.h"
@@ -15,6 +18,7 @@
 #include "Serialization/MemoryReader.h"
 #include "Serialization/MemoryWriter.h"
 #include "Async/Async.h"
+#include "Containers/LruCache.h"
 #include "DrawDebugHelpers.h"
 #include "Components/ActorComponent.h"
 #include "GameFramework/Character.h"
@@ -53,6 +57,16 @@ struct FVoxelSaveData
         return ChunkCell == RHS.ChunkCell;
     }
 };
+struct FCachedHeightmap
+{
+    TArray<int16> Heightmap;
+    TArray<int32> TerrainZIndices; // The vertical chunk indices the terrain passes through, as returned by GenerateHeightmap
+};
+struct FBiomeNoiseLayer
+{
+    const FastNoise::Generator* Generator; // Leave null for biomes with flat terrain
+    float HeightScale;
+};
 class AChunkActor;
 class AVoxelGameMode;
 class AChunkManager;
@@ -71,8 +85,7 @@ public:
         int32 ChunkGenRadius,
         int32 ChunkDeletionBuffer,
         int32 AdjacentVoxelBuffer,
-        float ThreadWorkingSleepTime,
-        float ThreadIdleSleepTime,
+        float ThreadCPUBudget,
         int32 TotalChunkVoxels,
         float ChunkSize,
         int32 VoxelCount,
@@ -83,14 +96,19 @@ public:
         float TerrainNoiseScale,
         float BiomeNoiseScale,
         int32 Seed,
+        bool bUseGreedyMeshing,
         FString WorldSaveName,
         int32 ThreadIndex)
         : VoxelGameModeRef(VoxelGameMode), VoxelDefinitions(VoxelDefinitions), WorldRef(World), ChunkManagerRef(ChunkManager), ChunkGenerationRadius(ChunkGenRadius), ChunkDeletionBuffer(ChunkDeletionBuffer),
-        AdjacentChunkVoxelBuffer(AdjacentVoxelBuffer), ThreadWorkingSleepTime(ThreadWorkingSleepTime), ThreadIdleSleepTime(ThreadIdleSleepTime), TotalChunkVoxels(TotalChunkVoxels),
+        AdjacentChunkVoxelBuffer(AdjacentVoxelBuffer), ThreadCPUBudget(ThreadCPUBudget), TotalChunkVoxels(TotalChunkVoxels),
         ChunkSize(ChunkSize), VoxelCount(VoxelCount), VoxelSize(VoxelSize), CollisionGenerationRadius(CollisionGenerationRadius), RegionSizeInChunks(RegionSizeInChunks),
         TerrainHeightMultiplier(TerrainHeightMultiplier), TerrainNoiseScale(TerrainNoiseScale), BiomeNoiseScale(BiomeNoiseScale), Seed(Seed),
-        WorldSaveName(WorldSaveName), ThreadIndex(ThreadIndex)
-    { Thread = FRunnableThread::Create(this, TEXT("ChunkThread"), 0, EThreadPriority::TPri_Lowest); }
+        bUseGreedyMeshing(bUseGreedyMeshing), WorldSaveName(WorldSaveName), ThreadIndex(ThreadIndex)
+    {
+        WorkEvent = FPlatformProcess::GetSynchEventFromPool(false);
+        Thread = FRunnableThread::Create(this, TEXT("ChunkThread"), 0, EThreadPriority::TPri_Lowest);
+    }
+    virtual ~FChunkThread() override;
      
     virtual bool Init() override; // Do not call manually
     virtual uint32 Run() override; // Do not call manually
@@ -100,30 +118,53 @@ public:
     bool UpdateTrackingVariables();
     void UpdateTempVariables();
     void UpdateChunks(); // Only the first ChunkThread runs this. This helps reduce the complexity of memory management for these operations
-    bool IsNeededHeightmapLocation(FVector2D NeededHeightmapLocation, const TArray<FVector2D>& PlayerLocations, int32 ChunkGenRadius, int32 CollisionGenRadius);
-    bool PrepareRegionForGeneration();
-    bool FindNextNeededHeightmap(FVector2D& OutHeightmapLocation, TArray<FVector2D>*& OutLocationsNeedingUnhide); // Returns true if ready to move on
-    static int32 CalculateCircumferenceInChunks(const int32 RadiusInChunks, float ChunkSize);
-    bool GenerateChunkData(FVector2D& HeightmapLocation, TArray<int32>& TerrainZIndices, TArray<TSharedPtr<FChunkConstructionData>>& ChunkConstructionDataArray);
+    bool IsNeededHeightmapCell(const FIntPoint& HeightmapCell, const TArray<FIntPoint>& TrackedCells, int32 ChunkGenRadius, int32 CollisionGenRadius);
+    bool IsHeightmapCellKept(const FIntPoint& HeightmapCell, const TArray<FIntPoint>& TrackedCells, const TArray<FIntPoint>& PredictedCells); // Whether UpdateChunks would keep this heightmap
+    bool IsClaimedHeightmapCellKept(const FIntPoint& HeightmapCell); // Checks against the latest published tracked cells. Call after StartJob, and release the claim if it returns false
+    void AddCellsLeavingRange(TSet<FIntPoint>& OutCells, const FIntPoint& OldCell, const FIntPoint& NewCell, const int32 RadiusInChunks); // Adds the heightmap cells within the radius of OldCell that aren't within it of NewCell
+    inline int32 GetGenRadius(int32 TrackedPlayerIndex) { return GetGenDistanceShouldBeCollision(TrackedPlayerIndex) ? TempCollisionGenRadius : TempChunkGenRadius; }
+    inline int32 GetKeepRadius(int32 TrackedPlayerIndex) { return GetGenRadius(TrackedPlayerIndex) + ChunkDeletionBuffer; } // Matches the radii IsHeightmapCellKept checks
+    inline int32 GetPredictionGenRadius(int32 TrackedPlayerIndex) { return FMath::Min(PredictionGenRadius, GetGenRadius(TrackedPlayerIndex)); } // Around a predicted cell. IsHeightmapCellKept adds the ChunkDeletionBuffer
+    void UpdatePendingRegions(); // Only the first ChunkThread runs this
+    void EnqueueNeededHeightmaps(); // Only the first ChunkThread runs this. Replaces the jobs in the ChunkJobQueue with every missing heightmap in range of the tracked locations
+    float GetHeightmapPriority(const FIntPoint& Offset, const FVector2D& ViewDirection, const FVector2D& Velocity) const; // Lower values are generated first. Offset is in chunks from the tracked location
+    bool PrepareRegionForGeneration(const FIntPoint& HeightmapCell); // Returns false if the region's data isn't ready yet
+    bool TryLoadRegion(const FIntPoint& Region); // Returns false if another ChunkThread is already loading the region
+    bool FindNextNeededHeightmap(FIntPoint& OutHeightmapCell); // Returns false if there are no jobs ready
+    void ThrottleToCPUBudget(const double WorkTime);
+    static TSharedPtr<const TArray<FIntPoint>> GetSpiralOffsets(const int32 RadiusInChunks); // Every 2D cell offset within the radius, closest first. Cached per radius
+    bool GenerateChunkData(const FIntPoint& HeightmapCell, TArray<int32>& TerrainZIndices, TArray<TSharedPtr<FChunkConstructionData>>& ChunkConstructionDataArray, const FChunkJobTokenPtr& JobToken); // Returns false if there is nothing to spawn or the job was cancelled
+    void ReleaseCancelledJob(const FIntPoint& HeightmapCell); // Lets the heightmap be claimed again if a player comes back for it
     FVector CalculateTangent(const FVector& Normal);
-    virtual void GenerateHeightmap(TArray<int16>& OutGeneratedHeightmap, const FVector2D& NeededHeightmapLocation, TArray<int32>& OutNeededChunksVerticalIndices);
-    void CombineChunkZIndices(const FVector2D& HeightmapLocation, TArray<int32>& TerrainZIndices);
-    bool AddConstructionData(TArray<TSharedPtr<FChunkConstructionData>>& OutNeededChunks, const FVector2D& ChunkLocation2D, const TArray<int32>& NeededChunksVerticalIndices);
+    void GetHeightmap(TArray<int16>& OutHeightmap, const FIntPoint& HeightmapCell, TArray<int32>& OutTerrainZIndices); // Uses the cached heightmap if there is one, otherwise generates and caches it
+    static void ResetHeightmapCache(const int32 MaxCachedHeightmaps); // Call before generating a new world. 0 disables the cache
+    virtual void GenerateHeightmap(TArray<int16>& OutGeneratedHeightmap, const FVector2D& NeededHeightmapLocation, TArray<int32>& OutNeededChunksVerticalIndices); // NeededHeightmapLocation is the world location of the heightmap cell, for sampling noise
+    void GenerateBlendedHeightmap(TArray<int16>& OutGeneratedHeightmap, const FVector2D& NeededHeightmapLocation, TArray<int32>& OutNeededChunksVerticalIndices, const TArray<FBiomeNoiseLayer>& BiomeLayers);
+    void GenerateNoiseForPositions(TArray<float>& OutNoise, const FastNoise::Generator* Generator, const FVector2D& NoiseStartPoint, const TArray<int32>& PositionIndices);
+    void CombineChunkZIndices(const FIntPoint& HeightmapCell, TArray<int32>& TerrainZIndices);
+    bool AddConstructionData(TArray<TSharedPtr<FChunkConstructionData>>& OutNeededChunks, const FIntPoint& HeightmapCell, const TArray<int32>& NeededChunksVerticalIndices);
     void GenerateVoxelsForChunks(TArray<TSharedPtr<FChunkConstructionData>>& OutConstructionChunks, const TArray<int16>& Heightmap);
-    virtual bool GenerateChunkVoxels(TArray<uint8>& Voxels, const TArray<int16>& Heightmap, const FVector& ChunkLocation);
+    virtual bool GenerateChunkVoxels(TArray<uint8>& Voxels, const TArray<int16>& Heightmap, const FVector& ChunkLocation); // Returns false if the chunk is all air or buried, so it has nothing to mesh
+    virtual bool GetUniformChunkVoxel(const FVector& ChunkLocation, const int32 LowestTerrainHeight, const int32 HighestTerrainHeight, uint8& OutUniformVoxel); // Returns true if every voxel in the chunk would be OutUniformVoxel
     void ApplyModifiedVoxelsToChunk(TArray<uint8>& Voxels, FIntVector ChunkCell);
     void GenerateMeshDataForChunks(TArray<TSharedPtr<FChunkConstructionData>>& OutConstructionChunks); // Returns false if construction data failed to generated
-    virtual void GenerateChunkMeshData(FChunkMeshData& OutChunkMeshData, TArray<uint8>& Voxels, const FIntVector ChunkCell, const bool bShouldGenerateCollisionAtChunkSpawn);
-    bool DoesLocationNeedCollision(FVector2D Location2D, const TArray<FVector2D>& PlayerLocations, int32 ChunkGenRadius);
-    void CompressVoxelData(TArray<TSharedPtr<FChunkConstructionData>>& ChunkConstructionDataArray);
-    void AsyncSpawnChunks(TArray<TSharedPtr<FChunkConstructionData>>& ChunkConstructionDataArray, const FVector2D& HeightmapLocation, const TArray<int32>& TerrainZIndices);
+    virtual void GenerateChunkMeshData(TArray<FChunkMeshData>& OutSlabMeshData, TArray<uint8>& Voxels, const FIntVector ChunkCell, const bool bShouldGenerateCollisionAtChunkSpawn, const uint32 SlabsToMesh = AllChunkSlabs); // Adds mesh data for each slab set in SlabsToMesh
+    void GenerateSlabMeshData(FChunkMeshData& OutChunkMeshData, const TArray<uint8>& Voxels, const TArray<uint64>& ExposedFaceMasks); // Meshes the slab set in OutChunkMeshData.SlabIndex
+    bool BuildExposedFaceMasks(const TArray<uint8>& Voxels, TArray<uint64>& OutExposedFaceMasks); // Returns false if the voxels can't be meshed
+    virtual bool IsVoxelOccluding(const uint8 VoxelValue) const; // Whether a voxel hides the faces of the voxels touching it
+    inline int32 GetFaceMaskIndex(const int32 FaceIndex, const int32 X, const int32 Y) const { return (FaceIndex * VoxelCount + X) * VoxelCount + Y; }
+    void GenerateGreedySlabMeshData(FChunkMeshData& OutChunkMeshData, const TArray<uint8>& Voxels, const TArray<uint64>& ExposedFaceMasks); // Merges coplanar faces of the same voxel value into rectangles
+    bool DoesCellNeedCollision(const FIntPoint& Cell2D, const TArray<FIntPoint>& TrackedCells, int32 ChunkGenRadius);
+    void PackVoxelData(TArray<TSharedPtr<FChunkConstructionData>>& ChunkConstructionDataArray); // Moves each chunk's voxels into palette storage once they are meshed
+    void QueueChunksForSpawn(TArray<TSharedPtr<FChunkConstructionData>>& ChunkConstructionDataArray); // Hands the chunks to the ChunkManager, which spawns them on the game thread within a time budget
 
-    bool ShouldSpawnHidden(FVector2D ChunkLocation, int32 ChunkGenRadius);
+    bool ShouldSpawnHidden(const FIntPoint& Cell2D, int32 ChunkGenRadius);
     void SpawnChunkFromConstructionData(TSharedPtr<FChunkConstructionData> OutNeededChunkPtr, int32 ChunkGenRadius, int32 CollisionGenRadius, bool bShouldGenerateMesh = true);
-    void SaveUnsavedRegions(bool bSaveAsync = true);
-    void AsyncSaveVoxelsForRegion(FIntPoint Region, FString SaveName, bool bRemoveDataWhenDone = false, bool bRunAsync = true);
-    void SaveVoxelsForRegion(const FString& SaveName, const FIntPoint& Region, bool bRemoveDataWhenDone);
+    void SaveUnsavedRegions(bool bSaveAsync = true); // Compacts the edit journal by saving every region changed since the last time
+    bool SaveVoxelsForRegion(const FString& SaveName, const FIntPoint& Region, bool bRemoveDataWhenDone); // Returns false if the region's changes didn't reach the disk. Request saves through the RegionSaveScheduler instead once it's started, so the same region is never saved twice at once
     void LoadVoxelsForRegion(FIntPoint Region, FString SaveName);
+    void RecoverEditJournal(); // Replays any edits a crash left in the journal into the region files. Call once the RegionSaveScheduler is started, before any region is loaded
+    FString GetSaveFolderPath(const FString& SaveName) const { return FPaths::Combine(FPaths::ProjectSavedDir(), SaveFolderName, SaveName); }
 
     void GetRegionsToSave(TArray<FIntPoint>& RegionsToSave);
     void GetRegionsToLoad(TArray<FIntPoint>& RegionsToLoad);
@@ -138,13 +179,13 @@ public:
     void DeleteSaveGame(FString WorldSaveName);
     TArray<FString> GetSaveFoldersNames();
 
-    static inline FVector2D GetLocationSnappedToChunkGrid2D(const FVector2D& CurrentLocation, float ChunkSize) { return FVector2D(FMath::GridSnap(CurrentLocation.X, ChunkSize), FMath::GridSnap(CurrentLocation.Y, ChunkSize)); }
-    inline FIntPoint GetRegionByLocation(const FVector2D& CurrentLocation) { return FIntPoint(FMath::GridSnap(CurrentLocation.X, ChunkSize * RegionSizeInChunks) / (ChunkSize * RegionSizeInChunks), FMath::GridSnap(CurrentLocation.Y, ChunkSize * RegionSizeInChunks) / (ChunkSize * RegionSizeInChunks)); } // Make sure this function matches the one in ChunkManager.h  
+    inline FIntPoint GetRegionByCell(const FIntPoint& Cell2D) { return FIntPoint(FMath::FloorToInt32((Cell2D.X + RegionSizeInChunks * 0.5) / RegionSizeInChunks), FMath::FloorToInt32((Cell2D.Y + RegionSizeInChunks * 0.5) / RegionSizeInChunks)); } // Make sure this function matches the one in ChunkManager.h  
     inline FVector GetLocationSnappedToChunkGrid(const FVector& CurrentLocation) { return (CurrentLocation / ChunkSize).GridSnap(ChunkSize); }
     inline bool GetGenDistanceShouldBeCollision(int32 TrackedPlayerIndex) { return ((TrackedPlayerIndex > 0 && WorldRef->GetNetMode() == NM_ListenServer) || WorldRef->GetNetMode() == NM_DedicatedServer); }
-    inline bool IsHeightmapInRange(const FVector2D& ChunkLocation2D, const FVector2D& TargetLocation2D, const int32& ChunkRadius) { return GetDistanceInChunks(ChunkLocation2D, TargetLocation2D) <= ChunkRadius; }
-    int32 GetDistanceInChunks(const FVector2D& ChunkLocation2D, const FVector2D& TargetLocation2D) { return FMath::CeilToInt32(FMath::Abs(FVector2D::Distance(ChunkLocation2D, TargetLocation2D)) / ChunkSize); }
+    static inline bool IsHeightmapInRange(const FIntPoint& HeightmapCell, const FIntPoint& TargetCell, const int32 ChunkRadius) { return GetDistanceInChunksSquared(HeightmapCell, TargetCell) <= static_cast<int64>(ChunkRadius) * ChunkRadius; }
+    static inline int64 GetDistanceInChunksSquared(const FIntPoint& CellA, const FIntPoint& CellB) { const int64 X{ static_cast<int64>(CellA.X) - CellB.X }; const int64 Y{ static_cast<int64>(CellA.Y) - CellB.Y }; return X * X + Y * Y; } // 64 bit so cells far apart can't overflow
     FVector2f CalculateUV(const int32& FaceIndex, const int32& VertIndex);
+    FVector2f CalculateTiledUV(const int32& FaceIndex, const int32& VertIndex, const FVector3f& QuadSizeInVoxels); // UVs repeat once per voxel across merged quads
 
     const FString SaveFolderName{ "SaveGames/WorldSaves/" };
 
@@ -162,6 +203,7 @@ protected:
     FastNoise::SmartNode<> MountainsNoiseGenerator;
 
     FCriticalSection ChunkGenMutex{};   
+    FCriticalSection SaveUnsavedRegionsMutex{}; // Autosave can fire again before a slow save finishes, and Stop has to wait for one in progress
 
     // === Settings (Set in Constructor) ===
     AVoxelGameMode* VoxelGameModeRef{};
@@ -171,8 +213,7 @@ protected:
     int32 ChunkGenerationRadius;
     int32 ChunkDeletionBuffer;
     int32 AdjacentChunkVoxelBuffer;
-    float ThreadWorkingSleepTime;
-    float ThreadIdleSleepTime;
+    float ThreadCPUBudget; // The fraction of time this thread spends working while it has jobs
     int32 TotalChunkVoxels;
     const float ChunkSize;
     const int32 VoxelCount;
@@ -183,33 +224,41 @@ protected:
     float TerrainNoiseScale;
     float BiomeNoiseScale;
     int32 Seed;
+    bool bUseGreedyMeshing;
 
     FString WorldSaveName{ "DefaultWorld" };
 
-    FVector2D LastHeightmapLocation{};
     bool bIsFirstTime{ true };
-    int32 TempGenrationRadius{ ChunkGenerationRadius };
     int32 TempCollisionGenRadius{ CollisionGenerationRadius };
     int32 TempChunkGenRadius{ ChunkGenerationRadius };
 
-	bool bFoundHeightmapOnLastCheck{ false };
 	bool bWasRangeChanged{ false };
 
     // Used by threads to determine which spot to generate next
-    TArray<FVector2D> PlayerLocations{};
-    int32 TrackedIndex{};
-    TArray<int32> TrackedChunkRingDistance{};
-    TArray<int32> TrackedChunkRingCount{};
+    TArray<FIntPoint> PlayerCells{}; // The 2D chunk cell each tracked player is in
+    TArray<FVector2D> PlayerViewDirections{}; // Matches PlayerCells by index. Zero when the player's view is unknown
+    TArray<FVector2D> PlayerVelocities{};
+    TArray<FIntPoint> PredictedPlayerCells{}; // Matches PlayerCells by index. Where each player is heading, so we can prefetch heightmaps along the way
+    const int32 PredictionGenRadius{ 3 }; // How far around a predicted cell we prefetch, in chunks. Small, since the player's own radius already covers the path there
+
+    // What the last UpdateChunks kept, so the next one only has to check the cells that left range since // Only the first ChunkThread uses these
+    TArray<FIntPoint> LastKeptPlayerCells{};
+    TArray<FIntPoint> LastKeptPredictedCells{};
+    int32 LastKeptChunkGenRadius{ -1 }; // -1 forces a full check the first time
+    int32 LastKeptCollisionGenRadius{ -1 };
+
+    static TShardedCellMap<TArray<int32>> ChunkZIndicesBy2DCell;
+    static TShardedCellMap<TArray<int32>> ModifiedAdditionalChunkZIndicesBy2DCell;
 
-    static FCriticalSection ChunkZMutex;
-    static TMap<FIntPoint, TArray<int32>> ChunkZIndicesBy2DCell;
-    static TMap<FIntPoint, TArray<int32>> ModifiedAdditionalChunkZIndicesBy2DCell;
+    static FCriticalSection SpiralOffsetsMutex;
+    static TMap<int32, TSharedPtr<const TArray<FIntPoint>>> SpiralOffsetsByRadius; // Lock the SpiralOffsetsMutex before accessing
+
+    static FCriticalSection HeightmapCacheMutex;
+    static TLruCache<FIntPoint, FCachedHeightmap> HeightmapCache; // Shared by every ChunkThread and keyed by 2D cell // Lock the HeightmapCacheMutex before accessing
 
     int32 ThreadIndex{ -1 };
-    int32 ChunkAngleIndex{};
-    int32 LastRingCount{ -1 };
-    int32 CircumferenceInChunks{};
     FRunnableThread* Thread{};
+    FEvent* WorkEvent{}; // Triggered by the ChunkJobQueue when there may be work for this thread
     
     const int32 CubeFaceOffsets[6] {
     1,                                // Positive X
@@ -221,9 +270,7 @@ protected:
     };
 };
 
-void RunLengthEncode(TArray<uint8>& InputData, FIntVector OwningChunkCell);
-void RunLengthDecode(TArray<uint8>& EncodedData, FIntVector OwningChunkCell);
-
+constexpr int32 MaxChunkVoxelCount{ 62 }; // A column of voxels plus its two border voxels must fit in a uint64 face mask
 const TArray<FVector> FaceDirections{ FVector::UpVector, FVector::DownVector, FVector::RightVector, FVector::LeftVector, FVector::ForwardVector, FVector::BackwardVector };
 const TArray<FIntVector> FaceIntDirections{ FIntVector(0,0,1), FIntVector(0,0,-1), FIntVector(0,1,0), FIntVector(0,-1,0), FIntVector(1,0,0), FIntVector(-1,0,0) };
 const TArray<TArray<FVector3f>> CubeVertLocations{
@@ -18,8 +18,7 @@ public:
         int32 ChunkGenRadius,
         int32 ChunkDeletionBuffer,
         int32 AdjacentVoxelBuffer,
-        float ThreadWorkingSleepTime,
-        float ThreadIdleSleepTime,
+        float ThreadCPUBudget,
         int32 TotalChunkVoxels,
         float ChunkSize,
         int32 VoxelCount,
@@ -30,6 +29,7 @@ public:
         float TerrainNoiseScale,
         float BiomeNoiseScale,
         int32 Seed,
+        bool bUseGreedyMeshing,
         FString WorldSaveName,
         int32 ThreadIndex)
         : FChunkThread(
@@ -40,8 +40,7 @@ public:
             ChunkGenRadius,
             ChunkDeletionBuffer,
             AdjacentVoxelBuffer,
-            ThreadWorkingSleepTime,
-            ThreadIdleSleepTime,
+            ThreadCPUBudget,
             TotalChunkVoxels,
             ChunkSize,
             VoxelCount,
@@ -52,6 +51,7 @@ public:
             TerrainNoiseScale,
             BiomeNoiseScale,
             Seed,
+            bUseGreedyMeshing,
             WorldSaveName,
             ThreadIndex)
     {}
@@ -60,5 +60,6 @@ protected:
 	void InitializeNoiseGenerators() override;
 	void GenerateHeightmap(TArray<int16>& OutGeneratedHeightmap, const FVector2D& NeededHeightmapLocation, TArray<int32>& OutNeededChunksVerticalIndices) override;
 	bool GenerateChunkVoxels(TArray<uint8>& Voxels, const TArray<int16>& Heightmap, const FVector& ChunkLocation) override;
-	void GenerateChunkMeshData(FChunkMeshData& OutChunkMeshData, TArray<uint8>& Voxels, const FIntVector ChunkCell, const bool bShouldGenerateCollisionAtChunkSpawn) override;
+	bool GetUniformChunkVoxel(const FVector& ChunkLocation, const int32 LowestTerrainHeight, const int32 HighestTerrainHeight, uint8& OutUniformVoxel) override;
+	bool IsVoxelOccluding(const uint8 VoxelValue) const override;
 };
\ No newline at end of file
@@ -0,0 +1,39 @@
+// Copyright(c) 2024 Endless98. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+
+// An append only log of every voxel edit since the region files were last brought up to date
+// Each UpdateModifiedVoxels call appends one small record, so a crash only loses what the OS hadn't written yet instead of everything since the last autosave
+// Compacting rotates the journal out, saves the changed regions, then deletes the rotated journal. Anything still on disk at startup is replayed into the region files
+class INFINITEVOXELTERRAINPLUGIN_API FEditJournal
+{
+public:
+	~FEditJournal();
+
+	bool Open(const FString& SaveFolderPath); // Starts appending to the world's journal, keeping anything already in it
+	void Close();
+	bool IsOpen() const;
+
+	void Append(const FIntVector& ChunkCell, const TArray<int32>& VoxelIndices, const TArray<uint8>& VoxelValues); // Does nothing until the journal is open
+
+	bool Rotate(); // Moves everything appended so far into the compacting journal and starts a fresh one
+	void DeleteCompactingJournal(); // Call once every region with an edit in the compacting journal has been saved
+
+	// Calls EditVisitor for each edit in the compacting journal and then the active one, oldest first. Only call before Open
+	static void ReadPendingEdits(const FString& SaveFolderPath, TFunctionRef<void(const FIntVector&, int32, uint8)> EditVisitor);
+	static void DeletePendingJournals(const FString& SaveFolderPath); // Only call before Open
+
+private:
+	static FString GetActivePath(const FString& SaveFolderPath);
+	static FString GetCompactingPath(const FString& SaveFolderPath);
+	static void ReadEdits(const FString& Path, TFunctionRef<void(const FIntVector&, int32, uint8)> EditVisitor);
+	bool OpenActiveJournal();
+
+	mutable FCriticalSection JournalMutex{};
+	TUniquePtr<IFileHandle> ActiveJournal{}; // Lock the JournalMutex before accessing
+	FString JournalFolderPath{}; // Lock the JournalMutex before accessing
+	TArray<uint8> RecordBuffer{}; // Reused by every Append. Lock the JournalMutex before accessing
+};
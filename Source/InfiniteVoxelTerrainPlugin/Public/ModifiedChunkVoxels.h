@@ -0,0 +1,32 @@
+// Copyright(c) 2024 Endless98. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// The player changes to a single chunk
+// Most chunks only have a handful of edited voxels, so they are stored as a sorted list of voxel indices and values
+// Once enough voxels are edited the list would cost more than it saves, so it switches to a full array of TotalChunkVoxels where UINT8_MAX means the voxel has not been modified
+// Save files and region data sent to clients always use the full array layout, so use ToDense and the dense constructor when converting
+class INFINITEVOXELTERRAINPLUGIN_API FModifiedChunkVoxels
+{
+public:
+	FModifiedChunkVoxels() {}
+	explicit FModifiedChunkVoxels(TArray<uint8>&& InDenseVoxels); // Takes a full array of TotalChunkVoxels and goes back to the sorted list if few voxels were modified
+
+	void SetVoxel(int32 VoxelIndex, uint8 VoxelValue, int32 TotalChunkVoxels);
+	bool ApplyToVoxels(TArray<uint8>& Voxels) const; // Overwrites every modified voxel. Returns false if the modified voxels don't fit in Voxels
+	void ToDense(TArray<uint8>& OutVoxels, int32 TotalChunkVoxels) const;
+
+	bool IsEmpty() const { return SparseIndices.IsEmpty() && DenseVoxels.IsEmpty(); }
+	bool IsDense() const { return !DenseVoxels.IsEmpty(); }
+	int32 GetDenseNum() const { return DenseVoxels.Num(); }
+
+private:
+	static bool ShouldBeDense(int32 ModifiedVoxelCount, int32 TotalChunkVoxels);
+	void PromoteToDense(int32 TotalChunkVoxels);
+
+	TArray<int32> SparseIndices{}; // Sorted so lookups can binary search. Matches SparseValues by index
+	TArray<uint8> SparseValues{};
+	TArray<uint8> DenseVoxels{};   // Empty until the chunk is promoted. Once promoted the sparse arrays are empty
+};
@@ -0,0 +1,37 @@
+// Copyright(c) 2024 Endless98. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// The voxels a spawned chunk keeps in memory
+// Each distinct voxel value goes in a small palette, and every voxel stores its palette index packed into 0, 1, 2, 4 or 8 bits depending on how many values the chunk uses
+// Reads and writes go straight to the packed bits, so a chunk never needs decompressing before it can be edited
+class INFINITEVOXELTERRAINPLUGIN_API FPaletteVoxelStorage
+{
+public:
+	void Pack(const TArray<uint8>& Voxels); // Picks the smallest bit width for the values in Voxels
+	void Unpack(TArray<uint8>& OutVoxels) const;
+	void Empty();
+
+	uint8 GetVoxel(int32 VoxelIndex) const; // Check IsValidIndex first
+	void SetVoxel(int32 VoxelIndex, uint8 VoxelValue); // Check IsValidIndex first. Widens the bits per voxel if the palette runs out of room
+
+	int32 Num() const { return VoxelNum; }
+	bool IsEmpty() const { return VoxelNum == 0; }
+	bool IsValidIndex(int32 VoxelIndex) const { return VoxelIndex >= 0 && VoxelIndex < VoxelNum; }
+	int32 GetBitsPerVoxel() const { return BitsPerVoxel; }
+	SIZE_T GetAllocatedSize() const { return Palette.GetAllocatedSize() + PackedIndices.GetAllocatedSize(); }
+
+private:
+	static int32 GetBitsForPaletteSize(int32 PaletteSize);
+	uint32 GetPaletteIndex(int32 VoxelIndex) const;
+	void SetPaletteIndex(int32 VoxelIndex, uint32 PaletteIndex);
+
+	TArray<uint8> Palette{};
+	TArray<uint32> PackedIndices{}; // Empty when BitsPerVoxel is 0, since every voxel is Palette[0]
+	int32 VoxelNum{};
+	int32 BitsPerVoxel{};
+	int32 VoxelsPerWordShift{}; // log2 of how many voxels fit in one uint32. The bit widths are powers of two, so a voxel never straddles two words
+	uint32 PaletteIndexMask{};
+};
@@ -0,0 +1,61 @@
+// Copyright(c) 2024 Endless98. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/MappedFileHandle.h"
+
+// Where one chunk's record sits in a region file
+struct FRegionFileRecord
+{
+	int64 Offset{};
+	int32 Length{};
+};
+
+// What we know about a region's file while the region is loaded
+struct FRegionFileState
+{
+	FString Path{};
+	TMap<FIntVector, FRegionFileRecord> RecordsByCell{}; // Every chunk in the file, whether or not its record has been read yet
+	TSet<FIntVector> DirtyCells{}; // Chunks edited since the file was written, so their records are stale
+};
+
+// A read only view of a whole file straight out of the OS page cache, so reading it doesn't copy it into our own buffers first
+// Some platforms can't map files, so check Open and fall back to reading the file normally. Keep the view short lived, since a mapped file can't be replaced on every platform
+class INFINITEVOXELTERRAINPLUGIN_API FMappedFileView
+{
+public:
+	bool Open(const FString& Path);
+	TConstArrayView<uint8> GetData() const;
+
+private:
+	TUniquePtr<IMappedFileHandle> FileHandle{};
+	TUniquePtr<IMappedFileRegion> MappedRegion{}; // Declared after FileHandle so it's unmapped before the file is closed
+};
+
+// The save file for one region
+// A small index at the front maps each chunk cell to its record, and every record is one chunk's voxels encoded on their own by FVoxelCodec
+// Loading a region only reads the index, so a chunk's record is only read and decoded the first time that chunk is needed
+// Reads go through FMappedFileView where the platform supports it, so records are decoded straight out of the mapped file instead of a copy
+class INFINITEVOXELTERRAINPLUGIN_API FRegionFile
+{
+public:
+	static FString GetPath(const FString& SaveFolderPath, const FIntPoint& Region);
+
+	static bool ReadIndex(const FString& Path, TMap<FIntVector, FRegionFileRecord>& OutRecordsByCell);
+	static bool VisitRecords(const FString& Path, const TMap<FIntVector, FRegionFileRecord>& RecordsByCell, TFunctionRef<void(const FIntVector&, TConstArrayView<uint8>)> Visitor); // Each record's view is only valid during its call. Opens the file once for every record
+	static bool ReadRecords(const FString& Path, const TMap<FIntVector, FRegionFileRecord>& RecordsByCell, TMap<FIntVector, TArray<uint8>>& OutRecordDataByCell); // Copies each record out, for when it has to outlive the file
+	static bool Write(const FString& Path, const TMap<FIntVector, TArray<uint8>>& RecordDataByCell, TMap<FIntVector, FRegionFileRecord>& OutRecordsByCell); // Writes to a temp file next to Path, which nobody reads, so it doesn't need the RegionFileMutex. Fills OutRecordsByCell with where each record was written
+	static bool CommitWrite(const FString& Path); // Replaces Path with what Write wrote. A crash before this leaves the old file whole, and on platforms that can't rename over a file, a crash during it leaves the temp file for RecoverInterruptedCommit
+	static void RecoverInterruptedCommit(const FString& Path); // Where CommitWrite can't rename over the old file, a crash partway through leaves only the temp file. Call before loading, while nothing is saving the region
+
+private:
+	static bool ReadIndexFromData(const FString& Path, TConstArrayView<uint8> HeaderAndIndexData, int64 FileSize, TMap<FIntVector, FRegionFileRecord>& OutRecordsByCell);
+	static bool ReadRecordFromHandle(class IFileHandle& FileHandle, const FRegionFileRecord& Record, TArray<uint8>& OutRecordData);
+	static FString GetTempPath(const FString& Path) { return Path + TEXT(".tmp"); }
+
+	static constexpr uint32 FileMagic{ 0x46525649 }; // "IVRF"
+	static constexpr uint32 FileVersion{ 1 };
+	static constexpr int64 HeaderSize{ sizeof(uint32) + sizeof(uint32) + sizeof(int32) }; // Magic, Version, RecordCount
+	static constexpr int64 IndexEntrySize{ sizeof(int32) * 3 + sizeof(int64) + sizeof(int32) }; // Cell, Offset, Length
+};
@@ -0,0 +1,44 @@
+// Copyright(c) 2024 Endless98. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Event.h"
+#include "Templates/Function.h"
+
+// Saves regions on background threads for the first ChunkThread, so autosave and unloading never write region files on the thread that asked
+// Asking again for a region that is still waiting merges the requests, and asking while it is being saved queues it once more for afterwards, so the same region is never saved twice at the same time
+// At most MaxConcurrentSaves regions are written at once, so a big autosave can't flood the disk or the task graph
+class INFINITEVOXELTERRAINPLUGIN_API FRegionSaveScheduler
+{
+public:
+	using FSaveRegionFunction = TFunction<bool(const FIntPoint& Region, bool bRemoveDataWhenDone)>; // Returns false if the region's changes didn't reach the disk
+
+	FRegionSaveScheduler();
+	~FRegionSaveScheduler(); // Waits for every requested save
+
+	void Start(FSaveRegionFunction InSaveRegion); // Requests made before Start are dropped
+	void Stop(); // Waits for every requested save, then drops any made afterwards
+
+	void RequestSave(const FIntPoint& Region, bool bRemoveDataWhenDone); // bRemoveDataWhenDone sticks if any merged request asked for it, since only unloaded regions ask for it and they can't be loaded again until the save finishes
+	void WaitForSaves(); // Blocks until nothing is waiting or being saved, including saves requested while we wait
+	void WaitForRegion(const FIntPoint& Region); // Blocks until the region has no save waiting or running. Call before loading a region, so the load can't read a file that is about to be replaced. Never call from a save
+	void TakeFailedRegions(TArray<FIntPoint>& OutRegions); // Every region that failed to save since the last call
+
+private:
+	void RunWorker();
+	bool IsSaveRequested(const FIntPoint& Region) const; // Lock the SchedulerMutex before calling
+
+	static constexpr int32 MaxConcurrentSaves{ 2 };
+
+	mutable FCriticalSection SchedulerMutex{};
+	FSaveRegionFunction SaveRegion{}; // Only changed while no worker is running // Lock the SchedulerMutex before accessing
+	bool bIsAcceptingRequests{}; // Lock the SchedulerMutex before accessing
+	TArray<FIntPoint> QueuedRegions{}; // Oldest request first // Lock the SchedulerMutex before accessing
+	TSet<FIntPoint> RegionsToRemoveWhenDone{}; // The queued regions that will have their data removed once saved // Lock the SchedulerMutex before accessing
+	TSet<FIntPoint> RegionsBeingSaved{}; // Lock the SchedulerMutex before accessing
+	TArray<FIntPoint> FailedRegions{}; // Lock the SchedulerMutex before accessing
+	int32 ActiveWorkers{}; // Lock the SchedulerMutex before accessing
+	FEvent* IdleEvent{}; // Triggered while no worker is running
+	TMultiMap<FIntPoint, FEvent*> RegionSavedEvents{}; // One for each WaitForRegion call, triggered once its region has no save waiting or running // Lock the SchedulerMutex before accessing
+};
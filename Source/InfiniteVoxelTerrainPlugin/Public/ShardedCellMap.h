@@ -0,0 +1,112 @@
+// Copyright(c) 2024 Endless98. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// A map keyed by 2D cell that every ChunkThread can use at once
+// Cells are split across shards by hash and each shard has its own lock, so threads only wait on each other when they touch cells in the same shard
+// Values are copied out rather than handed out by pointer, since a pointer would outlive the shard lock. Use Modify or ModifyIfFound to change a value in place
+template<typename ValueType, int32 ShardCount = 64>
+class TShardedCellMap
+{
+	static_assert((ShardCount & (ShardCount - 1)) == 0, "ShardCount must be a power of two");
+
+public:
+	bool Contains(const FIntPoint& Cell) const
+	{
+		const FShard& Shard{ GetShard(Cell) };
+		FScopeLock Lock(&Shard.Mutex);
+		return Shard.ValuesByCell.Contains(Cell);
+	}
+
+	bool Find(const FIntPoint& Cell, ValueType& OutValue) const // Returns false if the cell isn't in the map
+	{
+		const FShard& Shard{ GetShard(Cell) };
+		FScopeLock Lock(&Shard.Mutex);
+		const ValueType* Value{ Shard.ValuesByCell.Find(Cell) };
+		if (!Value)
+			return false;
+
+		OutValue = *Value;
+		return true;
+	}
+
+	bool TryAdd(const FIntPoint& Cell, const ValueType& Value = ValueType()) // Returns false if the cell was already in the map, so only one thread can claim a cell
+	{
+		FShard& Shard{ GetShard(Cell) };
+		FScopeLock Lock(&Shard.Mutex);
+		if (Shard.ValuesByCell.Contains(Cell))
+			return false;
+
+		Shard.ValuesByCell.Add(Cell, Value);
+		return true;
+	}
+
+	template<typename FuncType>
+	void Modify(const FIntPoint& Cell, FuncType&& Func) // Adds a default value first if the cell isn't in the map. Func is called with the shard locked, so keep it short
+	{
+		FShard& Shard{ GetShard(Cell) };
+		FScopeLock Lock(&Shard.Mutex);
+		Func(Shard.ValuesByCell.FindOrAdd(Cell));
+	}
+
+	template<typename FuncType>
+	bool ModifyIfFound(const FIntPoint& Cell, FuncType&& Func) // Returns false without calling Func if the cell isn't in the map
+	{
+		FShard& Shard{ GetShard(Cell) };
+		FScopeLock Lock(&Shard.Mutex);
+		ValueType* Value{ Shard.ValuesByCell.Find(Cell) };
+		if (!Value)
+			return false;
+
+		Func(*Value);
+		return true;
+	}
+
+	bool Remove(const FIntPoint& Cell)
+	{
+		FShard& Shard{ GetShard(Cell) };
+		FScopeLock Lock(&Shard.Mutex);
+		return Shard.ValuesByCell.Remove(Cell) > 0;
+	}
+
+	bool RemoveAndCopyValue(const FIntPoint& Cell, ValueType& OutValue)
+	{
+		FShard& Shard{ GetShard(Cell) };
+		FScopeLock Lock(&Shard.Mutex);
+		return Shard.ValuesByCell.RemoveAndCopyValue(Cell, OutValue);
+	}
+
+	void GetCells(TArray<FIntPoint>& OutCells) const // Each shard is copied under its own lock, so cells added or removed meanwhile may or may not be included
+	{
+		OutCells.Reset();
+		for (const FShard& Shard : Shards)
+		{
+			FScopeLock Lock(&Shard.Mutex);
+			for (const TPair<FIntPoint, ValueType>& CellValuePair : Shard.ValuesByCell)
+				OutCells.Add(CellValuePair.Key);
+		}
+	}
+
+	void Empty()
+	{
+		for (FShard& Shard : Shards)
+		{
+			FScopeLock Lock(&Shard.Mutex);
+			Shard.ValuesByCell.Empty();
+		}
+	}
+
+private:
+	struct FShard
+	{
+		mutable FCriticalSection Mutex{};
+		TMap<FIntPoint, ValueType> ValuesByCell{}; // Lock the Mutex before accessing
+	};
+
+	FShard& GetShard(const FIntPoint& Cell) { return Shards[GetTypeHash(Cell) & (ShardCount - 1)]; }
+	const FShard& GetShard(const FIntPoint& Cell) const { return Shards[GetTypeHash(Cell) & (ShardCount - 1)]; }
+
+	FShard Shards[ShardCount];
+};
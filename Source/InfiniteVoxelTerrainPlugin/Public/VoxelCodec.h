@@ -0,0 +1,41 @@
+// Copyright(c) 2024 Endless98. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Stored in the first byte of every encoded chunk, so never reorder or remove these
+enum class EVoxelCodec : uint8
+{
+	Raw,
+	RunLength,       // (Count, Value) byte pairs, so runs are capped at 255 voxels. Everything was stored this way before codecs
+	VarintRunLength, // Run lengths are varints, so a solid chunk is a few bytes instead of hundreds
+	LZ4,
+	Zlib,
+	Oodle,
+};
+
+// Compresses a chunk's voxels for save files and region data sent to clients
+// Every codec is tried and the smallest result is kept, with its codec in a leading format byte so Decode knows how to read it
+// The general purpose codecs are only tried when the run length codecs leave a chunk large, since they cost far more time and rarely help chunks that are mostly long runs
+class INFINITEVOXELTERRAINPLUGIN_API FVoxelCodec
+{
+public:
+	static void Encode(TConstArrayView<uint8> Voxels, TArray<uint8>& OutEncodedData, bool bFast = false); // bFast only tries VarintRunLength and LZ4, for when the encoding holds up the game thread
+	static bool Decode(TConstArrayView<uint8> EncodedData, TArray<uint8>& OutVoxels); // Returns false if the data is damaged or its codec isn't available on this platform
+
+private:
+	static bool EncodePayload(EVoxelCodec Codec, TConstArrayView<uint8> Voxels, TArray<uint8>& OutEncodedData); // Appends to OutEncodedData. Returns false if the codec isn't available
+	static bool DecodePayload(EVoxelCodec Codec, TConstArrayView<uint8> Payload, TArray<uint8>& OutVoxels);
+	static FName GetCompressionFormat(EVoxelCodec Codec); // NAME_None for the codecs we implement ourselves
+	static void WriteVarint(TArray<uint8>& OutData, uint32 Value);
+	static bool ReadVarint(TConstArrayView<uint8> Data, int32& InOutIndex, uint32& OutValue);
+
+	static constexpr int32 MinSizeForGeneralCodecs{ 256 }; // Below this many bytes the run length codecs are kept as they are
+	static constexpr int32 MaxDecodedSize{ 1 << 24 }; // Far more than any chunk, so damaged data can't make us allocate without limit
+};
+
+void RunLengthEncode(TArray<uint8>& InputData, FIntVector OwningChunkCell);
+void RunLengthEncode(TConstArrayView<uint8> Voxels, TArray<uint8>& OutEncodedData); // Appends to OutEncodedData
+void RunLengthDecode(TArray<uint8>& EncodedData, FIntVector OwningChunkCell);
+void RunLengthDecode(TConstArrayView<uint8> EncodedData, TArray<uint8>& OutDecodedData); // Decodes without copying the encoded data first, such as straight out of a mapped file